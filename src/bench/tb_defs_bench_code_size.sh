@@ -0,0 +1,68 @@
+#!/bin/bash
+# Copyright 2026 Oticon A/S
+# SPDX-License-Identifier: Apache-2.0
+
+# Measures the code size and compile time of tb_defs.h macro expansions, per 1000 macros, for the current tb_defs.h
+# and for a baseline version of it taken from git (by default the first commit of the repository). The test bench that
+# is compiled is generated by this script and uses a mix of TB_CHECKPOINT, TB_WAIT_COND_ASSERT, TB_IF, TB_WAIT_UNTIL,
+# and TB_ENDIF.
+#
+# Usage: tb_defs_bench_code_size.sh [baseline git revision]
+# Environment: CC (default gcc), CFLAGS (default -O2), BENCH_NBR_MACROS (default 1000), BENCH_COMPILE_RUNS (default 3)
+
+set -e
+
+cd "$(dirname "$0")"
+CC=${CC:-gcc}
+CFLAGS=${CFLAGS:--O2}
+NBR_MACROS=${BENCH_NBR_MACROS:-1000}
+COMPILE_RUNS=${BENCH_COMPILE_RUNS:-3}
+BASELINE=${1:-$(git rev-list --max-parents=0 HEAD | tail -n 1)}
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "${WORK_DIR}"' EXIT
+
+# Generate the test bench (5 macros per group)
+SRC=${WORK_DIR}/bench_tb.c
+{
+    echo '#include "tb_defs_unit_test_utils.h"'
+    echo '#include "tb_defs.h"'
+    echo 'TB_GLOBALS'
+    echo 'static bool flag;'
+    echo 'void bench_tick(bs_time_t HW_device_time)'
+    echo '{'
+    echo '    TB_CHECKPOINT_SEQ({0,0})'
+    echo '    TB_BEGIN'
+    for ((i = 0; i < NBR_MACROS / 5; i++)); do
+        echo "    TB_CHECKPOINT($i);"
+        echo "    TB_WAIT_COND_ASSERT(flag, 1e3, \"Flag not set in group %d\", $i);"
+        echo "    TB_IF(flag)"
+        echo "        TB_WAIT_UNTIL(($i + 1) * 1e6);"
+        echo "    TB_ENDIF"
+    done
+    echo '    TB_END'
+    echo '}'
+} > "${SRC}"
+
+mkdir -p "${WORK_DIR}/baseline"
+git show "${BASELINE}:src/tb_defs.h" > "${WORK_DIR}/baseline/tb_defs.h"
+
+# Prints "<text size in bytes> <compile time in ms>" for the test bench compiled with the tb_defs.h in directory $1
+measure() {
+    local best_ms=
+    for ((run = 0; run < COMPILE_RUNS; run++)); do
+        local start=$(date +%s%N)
+        ${CC} ${CFLAGS} -std=c99 -w -I"$1" -I../test -c "${SRC}" -o "${WORK_DIR}/bench_tb.o"
+        local ms=$(( ($(date +%s%N) - start) / 1000000 ))
+        if [ -z "${best_ms}" ] || [ ${ms} -lt ${best_ms} ]; then best_ms=${ms}; fi
+    done
+    echo "$(size -A "${WORK_DIR}/bench_tb.o" | awk '$1 == ".text" { print $2 }') ${best_ms}"
+}
+
+read base_size base_ms <<< "$(measure "${WORK_DIR}/baseline")"
+read cur_size cur_ms <<< "$(measure ..)"
+
+per_1000() { echo $(( $1 * 1000 / NBR_MACROS )); }
+echo "tb_defs code size benchmark: ${NBR_MACROS} macros, ${CC} ${CFLAGS}"
+printf "%-30s %16s %22s\n" "tb_defs.h" "bytes/1000 macros" "compile ms/1000 macros"
+printf "%-30s %16d %22d\n" "baseline (${BASELINE:0:12})" $(per_1000 ${base_size}) $(per_1000 ${base_ms})
+printf "%-30s %16d %22d\n" "current" $(per_1000 ${cur_size}) $(per_1000 ${cur_ms})
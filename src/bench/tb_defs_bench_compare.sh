@@ -0,0 +1,50 @@
+#!/bin/bash
+# Copyright 2026 Oticon A/S
+# SPDX-License-Identifier: Apache-2.0
+
+# Compares the output of tb_defs_bench_scenarios against a stored baseline output, and flags a scenario as regressed
+# when its simulated seconds per wall-clock second dropped, or its tick handler entries per simulated second rose, by
+# more than the threshold. Scenarios missing from either file are reported but not flagged.
+#
+# Usage: tb_defs_bench_compare.sh <baseline file> <current file> [threshold in percent, default 10]
+# Exit status: 0 if no scenario regressed, 1 otherwise
+
+set -e
+
+if [ $# -lt 2 ]; then
+    echo "Usage: $0 <baseline file> <current file> [threshold in percent, default 10]" >&2
+    exit 2
+fi
+BASELINE=$1
+CURRENT=$2
+THRESHOLD=${3:-10}
+
+awk -v threshold="${THRESHOLD}" '
+    $1 != "scenario" { next }
+    FNR == NR { base_speed[$2] = $4; base_entries[$2] = $6; next }
+    {
+        seen[$2] = 1
+        if (!($2 in base_speed)) {
+            printf("%-20s not in baseline\n", $2)
+            next
+        }
+        speed_change = base_speed[$2] > 0 ? 100 * ($4 - base_speed[$2]) / base_speed[$2] : 0
+        entries_change = base_entries[$2] > 0 ? 100 * ($6 - base_entries[$2]) / base_entries[$2] : 0
+        verdict = "ok"
+        if (speed_change < -threshold || entries_change > threshold) {
+            verdict = "REGRESSION"
+            nbr_regressions++
+        }
+        printf("%-20s sim_s_per_wall_s %12.1f -> %12.1f (%+6.1f%%)  entries_per_sim_s %12.1f -> %12.1f (%+6.1f%%)  %s\n",
+            $2, base_speed[$2], $4, speed_change, base_entries[$2], $6, entries_change, verdict)
+    }
+    END {
+        for (name in base_speed)
+            if (!(name in seen))
+                printf("%-20s missing from current run\n", name)
+        if (nbr_regressions > 0) {
+            printf("%d scenario(s) regressed by more than %s%%\n", nbr_regressions, threshold)
+            exit 1
+        }
+    }
+' "${BASELINE}" "${CURRENT}"
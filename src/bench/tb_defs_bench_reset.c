@@ -0,0 +1,100 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// Measures the per-scenario overhead of running the rows of a parameter table back-to-back in one process with
+// TB_RUN_TABLE, compared to starting a new process per row. The scenario is a short test sequence (a few waits in a
+// loop and a TB_CALL) run against the unit test stand-in scheduler, so the figures are dominated by the overhead.
+//
+// Usage: tb_defs_bench_reset [<number of in-process rows> [<number of process rows>]]
+//        tb_defs_bench_reset -row=<row>   (runs a single row; used for the process per row measurement)
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <string.h>
+#include <time.h>
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Reset bench: "
+
+TB_GLOBALS
+
+static bool is_done;
+static unsigned int nbr_iterations;
+
+void bench_sub_func(TB_CONTEXT_PARAM)
+{
+    TB_BEGIN
+    TB_WAIT(10);
+    TB_END
+}
+
+void bench_tick(bs_time_t HW_device_time)
+{
+    TB_LOCAL(unsigned int, iteration, 0);
+
+    TB_BEGIN
+    TB_WHILE(iteration < nbr_iterations)
+        TB_WAIT(100);
+        TB_CALL(bench_sub_func);
+        iteration++;
+    TB_ENDWHILE
+    is_done = true;
+    TB_END
+}
+
+static bool run_row(unsigned int row)
+{
+    tb_defs_unit_test_reset();
+    is_done = false;
+    nbr_iterations = 1 + row % 4;
+    bst_ticker_set_next_tick_absolute(0);
+    tb_defs_unit_test_scheduler(bench_tick);
+    return is_done;
+}
+
+static double wall_time_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[])
+{
+    static bool rows[100000];
+    unsigned int nbr_process_rows = 200;
+    unsigned int nbr_rows = sizeof(rows) / sizeof(rows[0]);
+    uint64_t failing_row;
+    double start;
+    double in_process_us;
+    double process_us;
+    char cmd[1024];
+
+    if (argc > 1 && strncmp(argv[1], "-row=", 5) == 0)
+        return run_row(atoi(argv[1] + 5)) ? 0 : 1;
+    if (argc > 1)
+        nbr_rows = atoi(argv[1]) < nbr_rows ? atoi(argv[1]) : nbr_rows;
+    if (argc > 2)
+        nbr_process_rows = atoi(argv[2]);
+
+    start = wall_time_s();
+    tb_run_table(tb_context_ptr, nbr_rows, run_row, &failing_row, 1);
+    in_process_us = (wall_time_s() - start) * 1e6 / nbr_rows;
+
+    start = wall_time_s();
+    for (unsigned int row = 0; row < nbr_process_rows; row++)
+    {
+        snprintf(cmd, sizeof(cmd), "%s -row=%u", argv[0], row);
+        if (system(cmd) != 0)
+            printf("Row %u failed\n", row);
+    }
+    process_us = (wall_time_s() - start) * 1e6 / nbr_process_rows;
+
+    printf("Per-scenario overhead: %.2f us in-process (TB_RUN_TABLE, %u rows), %.0f us process per row (%u rows), "
+        "%.0fx\n", in_process_us, nbr_rows, process_us, nbr_process_rows, process_us / in_process_us);
+    return 0;
+}
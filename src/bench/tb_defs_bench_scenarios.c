@@ -0,0 +1,252 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// Scenario macro-benchmarks: synthetic test benches modelled on real protocol test benches, run against the unit test
+// stand-in scheduler. For each scenario, the simulated seconds per wall-clock second and the tick handler entries per
+// simulated second are printed in the format read by tb_defs_bench_compare.sh:
+//
+//   scenario <name> sim_s_per_wall_s <value> entries_per_sim_s <value>
+//
+// Scenarios:
+// - conn_event_loop: connection events at a fixed interval, each exchanging a varying number of packets, with nested
+//   TB_FOR/TB_IF and radio events signalled by an event handler.
+// - event_storm: bursts of events signalled at the same time, consumed with TB_WAIT_COND_W_DEADLINE_DELTA.
+// - deep_call: a library of sub-test sequences calling each other 8 levels deep with TB_CALL, with waits at each level.
+//
+// Each scenario is run several times, and the fastest run is reported, to reduce the noise from the host.
+//
+// Usage: tb_defs_bench_scenarios [<scale factor, default 1>]
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <string.h>
+#include <time.h>
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Scenario bench: "
+
+TB_GLOBALS
+
+static tb_defs_unit_test_tick_handler_t scenario_tick;
+static unsigned long long nbr_entries;
+static unsigned int scale = 1;
+
+#define NBR_REPETITIONS 5
+
+// Tick handler given to the scheduler and to TB_SIGNAL_EVENT, counting the tick handler entries
+void bench_tick(bs_time_t HW_device_time)
+{
+    nbr_entries++;
+    scenario_tick(HW_device_time);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Connection event loop
+
+#define CONN_INTERVAL 7500
+#define NBR_CONN_EVENTS 500000
+
+static unsigned int conn_event;
+static unsigned int pkt;
+static bool is_rx_done;
+
+void radio_rx_handler(void)
+{
+    is_rx_done = true;
+    TB_SIGNAL_EVENT(bench_tick);
+}
+
+void conn_event_loop_tick(bs_time_t HW_device_time)
+{
+    TB_BEGIN
+    TB_FOR(conn_event = 0, conn_event < NBR_CONN_EVENTS * scale, conn_event++)
+        TB_WAIT_UNTIL((bs_time_t)conn_event * CONN_INTERVAL);
+        TB_FOR(pkt = 0, pkt < 1 + conn_event % 4, pkt++)
+            TB_IF(pkt % 2 == 0)
+                // Transmit, then wait for the response
+                TB_WAIT(80 + 8 * (conn_event % 32));
+                is_rx_done = false;
+                tb_defs_unit_test_schedule_special_event_delta(150, radio_rx_handler);
+                TB_WAIT_COND_W_DEADLINE_DELTA(is_rx_done, 500);
+            TB_ELSIF(conn_event % 8 == 0)
+                // Occasional missed packet
+                TB_WAIT(1000);
+            TB_ELSE
+                TB_WAIT(150);
+            TB_ENDIF
+        TB_ENDFOR
+    TB_ENDFOR
+    TB_END
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Event storm
+
+#define NBR_BURSTS 500000
+#define BURST_SIZE 8
+
+static unsigned int burst;
+static unsigned int nbr_events;
+
+void storm_event_handler(void)
+{
+    nbr_events++;
+    TB_SIGNAL_EVENT(bench_tick);
+}
+
+void event_storm_tick(bs_time_t HW_device_time)
+{
+    TB_BEGIN
+    TB_FOR(burst = 0, burst < NBR_BURSTS * scale, burst++)
+        nbr_events = 0;
+        for (int i = 0; i < BURST_SIZE; i++)
+            tb_defs_unit_test_schedule_special_event_delta(10 + 5 * (i / 2), storm_event_handler);
+        TB_WAIT_COND_W_DEADLINE_DELTA(nbr_events == BURST_SIZE, 100);
+        TB_WAIT(50);
+    TB_ENDFOR
+    TB_END
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+// Deep TB_CALL library
+
+#define NBR_CALL_ROUNDS 4000
+
+// Each library level waits, calls the level below twice, and waits again. (The levels cannot be generated by a macro,
+// as the resume points of the TB_ macros are identified by their line numbers.)
+void lib_level_0(TB_CONTEXT_PARAM)
+{
+    TB_BEGIN
+    TB_WAIT(1);
+    TB_END
+}
+
+void lib_level_1(TB_CONTEXT_PARAM)
+{
+    TB_BEGIN
+    TB_WAIT(2);
+    TB_CALL(lib_level_0);
+    TB_CALL(lib_level_0);
+    TB_WAIT(2);
+    TB_END
+}
+
+void lib_level_2(TB_CONTEXT_PARAM)
+{
+    TB_BEGIN
+    TB_WAIT(3);
+    TB_CALL(lib_level_1);
+    TB_CALL(lib_level_1);
+    TB_WAIT(2);
+    TB_END
+}
+
+void lib_level_3(TB_CONTEXT_PARAM)
+{
+    TB_BEGIN
+    TB_WAIT(4);
+    TB_CALL(lib_level_2);
+    TB_CALL(lib_level_2);
+    TB_WAIT(2);
+    TB_END
+}
+
+void lib_level_4(TB_CONTEXT_PARAM)
+{
+    TB_BEGIN
+    TB_WAIT(5);
+    TB_CALL(lib_level_3);
+    TB_CALL(lib_level_3);
+    TB_WAIT(2);
+    TB_END
+}
+
+void lib_level_5(TB_CONTEXT_PARAM)
+{
+    TB_BEGIN
+    TB_WAIT(6);
+    TB_CALL(lib_level_4);
+    TB_CALL(lib_level_4);
+    TB_WAIT(2);
+    TB_END
+}
+
+void lib_level_6(TB_CONTEXT_PARAM)
+{
+    TB_BEGIN
+    TB_WAIT(7);
+    TB_CALL(lib_level_5);
+    TB_CALL(lib_level_5);
+    TB_WAIT(2);
+    TB_END
+}
+
+void lib_level_7(TB_CONTEXT_PARAM)
+{
+    TB_BEGIN
+    TB_WAIT(8);
+    TB_CALL(lib_level_6);
+    TB_CALL(lib_level_6);
+    TB_WAIT(2);
+    TB_END
+}
+
+static unsigned int call_round;
+
+void deep_call_tick(bs_time_t HW_device_time)
+{
+    TB_BEGIN
+    TB_FOR(call_round = 0, call_round < NBR_CALL_ROUNDS * scale, call_round++)
+        TB_CALL(lib_level_7);
+    TB_ENDFOR
+    TB_END
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+
+static double wall_time_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Runs the scenario NBR_REPETITIONS times, and reports the fastest run, as that is the least disturbed by the host
+static void run_scenario(const char *name, tb_defs_unit_test_tick_handler_t tick)
+{
+    double start;
+    double wall_s;
+    double best_wall_s = 0;
+    double sim_s = 0;
+
+    for (int repetition = 0; repetition < NBR_REPETITIONS; repetition++)
+    {
+        TB_RESET(tb_context_ptr);
+        tb_defs_unit_test_reset();
+        scenario_tick = tick;
+        nbr_entries = 0;
+        bst_ticker_set_next_tick_absolute(0);
+        start = wall_time_s();
+        tb_defs_unit_test_scheduler(bench_tick);
+        wall_s = wall_time_s() - start;
+        if (repetition == 0 || wall_s < best_wall_s)
+            best_wall_s = wall_s;
+        sim_s = tm_get_hw_time() / 1e6;
+    }
+    printf("scenario %s sim_s_per_wall_s %.1f entries_per_sim_s %.1f\n", name, sim_s / best_wall_s,
+        nbr_entries / sim_s);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+        scale = atoi(argv[1]);
+    run_scenario("conn_event_loop", conn_event_loop_tick);
+    run_scenario("event_storm", event_storm_tick);
+    run_scenario("deep_call", deep_call_tick);
+    return 0;
+}
@@ -0,0 +1,1373 @@
+/**
+ * Copyright 2017-2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ *
+ * This file is a derivative of a work licensed to Oticon A/S under the
+ * SPDX-License-Identifier: MIT
+ * by Paul Emmanuel Wad, with Copyright of 2016-2018
+ */
+
+// This file contains the out-of-line parts of tb_defs.h: the slow paths (error reporting) and bookkeeping which would
+// otherwise be expanded inline at every use of the macros, bloating the test bench tick handlers.
+
+// For clock_gettime() and getrusage(), as the library is otherwise built as C99
+#define _DEFAULT_SOURCE
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <time.h>
+#include <sys/resource.h>
+
+#ifdef TB_DEFS_ENV_HEADER
+// Alternative environment providing the BabbleSim API used below (e.g. the stand-ins used by the unit tests)
+#include TB_DEFS_ENV_HEADER
+#else
+#include "bs_types.h"
+#include "bs_tracing.h"
+#include "bs_string.h"
+// Provided by the device the test bench is linked with (normally declared in time_machine.h)
+bs_time_t tm_get_hw_time(void);
+void bst_ticker_set_next_tick_absolute(bs_time_t time);
+#endif
+
+// The runtime itself has no test sequences to cover
+#undef TB_COVERAGE
+#include "tb_defs.h"
+
+// Set while tb_seed_sweep() runs the test for a seed; failures then end the run instead of the process
+static jmp_buf *tb_sweep_failure_jmp_buf = NULL;
+static char tb_sweep_failure_msg[256];
+
+// Contexts registered with TB_FINISH_REGISTER (or by their TB_FINISH), and the number of them not finished yet
+static tb_context_t *tb_finish_contexts = NULL;
+static unsigned int tb_finish_nbr_pending = 0;
+static void (*tb_finish_hook)(bool passed) = NULL;
+
+void tb_assert_failed(const char *file, unsigned int line, const char *fmt_str, ...)
+{
+    va_list variable_args;
+    va_start(variable_args, fmt_str);
+    if (tb_sweep_failure_jmp_buf)
+    {
+        vsnprintf(tb_sweep_failure_msg, sizeof(tb_sweep_failure_msg), fmt_str, variable_args);
+        va_end(variable_args);
+        longjmp(*tb_sweep_failure_jmp_buf, 1);
+    }
+    bs_trace_vprint(BS_TRACE_ERROR, file, line, 0, BS_TRACE_TIME_PROVIDED, tm_get_hw_time(), fmt_str, variable_args);
+    va_end(variable_args);
+}
+
+void tb_checkpoint_failed(tb_context_t *context, int val, const char *print_prefix, const char *file,
+    unsigned int line)
+{
+    int idx = context->checkpoint_idx++;
+    char strbuf[20];
+
+    if (context->checkpoints == NULL)
+    {
+        tb_assert_failed(file, line, "%sTB_ASSERT failed: TB_CHECKPOINT without TB_CHECKPOINT_SEQ!\n", print_prefix);
+        return;
+    }
+    if (idx >= context->nbr_checkpoints)
+    {
+        tb_assert_failed(file, line, "%sTB_ASSERT failed: More TB_CHECKPOINTs than items in TB_CHECKPOINT_SEQ!\n",
+            print_prefix);
+        return;
+    }
+    tb_assert_failed(file, line, "%sTB_ASSERT failed: TB_CHECKPOINT != TB_CHECKPOINT_SEQ[%d]: actual value=%d, "
+        "expected value=%d, expected time=%s\n", print_prefix, idx, val, context->checkpoints[idx].val,
+        bs_time_to_str(strbuf, context->checkpoints[idx].time));
+}
+
+void tb_checkpoint_log_full(tb_context_t *context, int val, const char *print_prefix, const char *file,
+    unsigned int line)
+{
+    tb_checkpoint_log_t *log = context->checkpoint_log;
+    if (log == NULL)
+    {
+        log = context->checkpoint_log = malloc(sizeof(tb_checkpoint_log_t));
+        if (log == NULL)
+        {
+            tb_assert_failed(__FILE__, __LINE__, "%sTB_ASSERT failed: Out of memory for checkpoint log\n",
+                print_prefix);
+            return;
+        }
+        log->nbr = 0;
+    }
+    else
+        tb_checkpoints_verify(context, print_prefix);
+    log->times[0] = tm_get_hw_time();
+    log->vals[0] = val;
+    log->files[0] = file;
+    log->lines[0] = line;
+    log->nbr = 1;
+}
+
+// The logged checkpoints are compared without branching, in one pass per run of matching checkpoints; only if there
+// is a mismatch (or more checkpoints than items) is the first one searched for and reported like in immediate mode.
+void tb_checkpoints_verify(tb_context_t *context, const char *print_prefix)
+{
+    tb_checkpoint_log_t *log = context->checkpoint_log;
+    unsigned int nbr = log ? log->nbr : 0;
+    unsigned int start = 0;
+
+    if (nbr == 0)
+        return;
+    // Emptied first, as a failure may not return (or may abort the run in a seed sweep)
+    log->nbr = 0;
+    while (start < nbr)
+    {
+        int idx = context->checkpoint_idx;
+        unsigned int nbr_remaining = context->checkpoints && idx < context->nbr_checkpoints ?
+            context->nbr_checkpoints - idx : 0;
+        unsigned int nbr_checkable = nbr - start < nbr_remaining ? nbr - start : nbr_remaining;
+        // No pointer arithmetic without a sequence left to point into (checkpoints may be NULL)
+        const tb_checkpoint_t *expected = nbr_remaining > 0 ? context->checkpoints + idx : NULL;
+        bool is_mismatch = false;
+        unsigned int i;
+
+        for (i = 0; i < nbr_checkable; i++)
+            is_mismatch |= (log->times[start + i] != expected[i].time) | (log->vals[start + i] != expected[i].val);
+        if (is_mismatch)
+            for (i = 0; log->times[start + i] == expected[i].time && log->vals[start + i] == expected[i].val; i++)
+                ;
+        context->checkpoint_idx = idx + i;
+        start += i;
+        if (start < nbr)
+        {
+            tb_checkpoint_failed(context, log->vals[start], print_prefix, log->files[start], log->lines[start]);
+            start++;
+        }
+    }
+}
+
+#define TB_XXH_PRIME1 0x9E3779B185EBCA87ULL
+#define TB_XXH_PRIME2 0xC2B2AE3D27D4EB4FULL
+#define TB_XXH_PRIME3 0x165667B19E3779F9ULL
+#define TB_XXH_PRIME4 0x85EBCA77C2B2AE63ULL
+#define TB_XXH_PRIME5 0x27D4EB2F165667C5ULL
+
+static uint64_t tb_rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+static uint64_t tb_xxh_round(uint64_t acc, uint64_t input)
+{
+    return tb_rotl(acc + input * TB_XXH_PRIME2, 31) * TB_XXH_PRIME1;
+}
+
+static uint64_t tb_xxh_read64(const unsigned char *p)
+{
+    uint64_t val;
+    memcpy(&val, p, sizeof(val)); // Little-endian host assumed, like the rest of BabbleSim
+    return val;
+}
+
+// XXH64 with seed 0. The 32-byte stripes are processed in four independent lanes, which the CPU executes in parallel.
+uint64_t tb_hash(const void *data, size_t len)
+{
+    const unsigned char *p = data;
+    const unsigned char *end = p + len;
+    uint64_t h;
+
+    if (len >= 32)
+    {
+        uint64_t v1 = TB_XXH_PRIME1 + TB_XXH_PRIME2;
+        uint64_t v2 = TB_XXH_PRIME2;
+        uint64_t v3 = 0;
+        uint64_t v4 = -TB_XXH_PRIME1;
+        for (; end - p >= 32; p += 32)
+        {
+            v1 = tb_xxh_round(v1, tb_xxh_read64(p));
+            v2 = tb_xxh_round(v2, tb_xxh_read64(p + 8));
+            v3 = tb_xxh_round(v3, tb_xxh_read64(p + 16));
+            v4 = tb_xxh_round(v4, tb_xxh_read64(p + 24));
+        }
+        h = tb_rotl(v1, 1) + tb_rotl(v2, 7) + tb_rotl(v3, 12) + tb_rotl(v4, 18);
+        h = (h ^ tb_xxh_round(0, v1)) * TB_XXH_PRIME1 + TB_XXH_PRIME4;
+        h = (h ^ tb_xxh_round(0, v2)) * TB_XXH_PRIME1 + TB_XXH_PRIME4;
+        h = (h ^ tb_xxh_round(0, v3)) * TB_XXH_PRIME1 + TB_XXH_PRIME4;
+        h = (h ^ tb_xxh_round(0, v4)) * TB_XXH_PRIME1 + TB_XXH_PRIME4;
+    }
+    else
+        h = TB_XXH_PRIME5;
+    h += len;
+
+    for (; end - p >= 8; p += 8)
+        h = tb_rotl(h ^ tb_xxh_round(0, tb_xxh_read64(p)), 27) * TB_XXH_PRIME1 + TB_XXH_PRIME4;
+    if (end - p >= 4)
+    {
+        uint32_t val;
+        memcpy(&val, p, sizeof(val));
+        h = tb_rotl(h ^ (val * TB_XXH_PRIME1), 23) * TB_XXH_PRIME2 + TB_XXH_PRIME3;
+        p += 4;
+    }
+    for (; p < end; p++)
+        h = tb_rotl(h ^ (*p * TB_XXH_PRIME5), 11) * TB_XXH_PRIME1;
+
+    h ^= h >> 33;
+    h *= TB_XXH_PRIME2;
+    h ^= h >> 29;
+    h *= TB_XXH_PRIME3;
+    h ^= h >> 32;
+    return h;
+}
+
+static void tb_checkpoint_buf_record(uint64_t hash, const void *data, size_t len, const char *print_prefix,
+    const char *file, unsigned int line)
+{
+    const unsigned char *bytes = data;
+
+    bs_trace_raw_time(3, "%sTB_CHECKPOINT_BUF: {%llu, 0x%016llx}, // %s:%u, %zu bytes\n", print_prefix,
+        (unsigned long long)tm_get_hw_time(), (unsigned long long)hash, file, line, len);
+    for (size_t offset = 0; offset < len; offset += 16)
+    {
+        char hex[16 * 3 + 1];
+        for (size_t i = 0; i < 16 && offset + i < len; i++)
+            sprintf(hex + 3 * i, " %02x", bytes[offset + i]);
+        bs_trace_raw(3, "%s  %06zx:%s\n", print_prefix, offset, hex);
+    }
+}
+
+void tb_checkpoint_buf(tb_context_t *context, const void *data, size_t len, const char *print_prefix, const char *file,
+    unsigned int line)
+{
+    uint64_t hash = tb_hash(data, len);
+    int idx = context->buf_checkpoint_idx++;
+    char strbuf[20];
+
+    if (context->record_buf_checkpoints)
+    {
+        tb_checkpoint_buf_record(hash, data, len, print_prefix, file, line);
+        return;
+    }
+    if (idx < context->nbr_buf_checkpoints && context->buf_checkpoints[idx].time == tm_get_hw_time() &&
+        context->buf_checkpoints[idx].hash == hash)
+        return;
+
+    if (context->buf_checkpoints == NULL)
+    {
+        tb_assert_failed(file, line, "%sTB_ASSERT failed: TB_CHECKPOINT_BUF without TB_CHECKPOINT_BUF_SEQ!\n",
+            print_prefix);
+        return;
+    }
+    if (idx >= context->nbr_buf_checkpoints)
+    {
+        tb_assert_failed(file, line,
+            "%sTB_ASSERT failed: More TB_CHECKPOINT_BUFs than items in TB_CHECKPOINT_BUF_SEQ!\n", print_prefix);
+        return;
+    }
+    tb_assert_failed(file, line, "%sTB_ASSERT failed: TB_CHECKPOINT_BUF != TB_CHECKPOINT_BUF_SEQ[%d]: "
+        "actual hash=0x%016llx, expected hash=0x%016llx, expected time=%s\n", print_prefix, idx,
+        (unsigned long long)hash, (unsigned long long)context->buf_checkpoints[idx].hash,
+        bs_time_to_str(strbuf, context->buf_checkpoints[idx].time));
+}
+
+void tb_wait_until_in_past(bs_time_t time, const char *print_prefix, const char *file, unsigned int line)
+{
+    char strbuf[20];
+    tb_assert_failed(file, line, "%sTB_ASSERT failed: TB_WAIT_UNTIL time %s is in the past!\n", print_prefix,
+        bs_time_to_str(strbuf, time));
+}
+
+void tb_wait_cond_begin(tb_context_t *context, bs_time_t deadline)
+{
+    context->waiting_deadline = deadline;
+    context->is_waiting_for_cond = true;
+    tb_set_next_tick(context, deadline);
+}
+
+void tb_wait_cond_end(tb_context_t *context)
+{
+    context->waiting_deadline = TIME_NEVER;
+    context->is_waiting_for_cond = false;
+    tb_set_next_tick(context, TIME_NEVER);
+}
+
+static void tb_wait_cond_poll_schedule(tb_context_t *context)
+{
+    bs_time_t poll_time = tm_get_hw_time() + context->poll_period;
+    tb_set_next_tick(context, poll_time < context->waiting_deadline ? poll_time : context->waiting_deadline);
+}
+
+void tb_wait_cond_poll_begin(tb_context_t *context, bs_time_t min_period, bs_time_t max_period, bs_time_t deadline)
+{
+    context->waiting_deadline = deadline;
+    context->is_waiting_for_cond = true;
+    context->poll_period = min_period > 0 ? min_period : 1;
+    context->poll_max_period = max_period > context->poll_period ? max_period : context->poll_period;
+    tb_wait_cond_poll_schedule(context);
+}
+
+// Called by TB_WAIT_COND_POLL when the condition is still false. TB_BEGIN clears the next tick time when the tick is
+// due, so a tick still pending means the sequence was entered due to a signalled event (or a timer), and the schedule
+// is kept.
+void tb_wait_cond_poll(tb_context_t *context)
+{
+    if (context->next_tick_time != TIME_NEVER)
+        return;
+    context->poll_period = context->poll_period <= context->poll_max_period / 2 ? 2 * context->poll_period :
+        context->poll_max_period;
+    tb_wait_cond_poll_schedule(context);
+}
+
+// Timers are kept in a hierarchical timer wheel: a timer is in the level given by the highest group of
+// TB_TIMER_WHEEL_BITS bits in which its expiry differs from the time the wheel has been advanced to, in the slot given
+// by that group of its expiry. All timers in a level thus expire before any timer in the next level, and are sorted by
+// slot, so starting and stopping timers is O(1), and the earliest expiry is found in the first occupied slot. Expiries
+// too far ahead for the top level are kept in an overflow list.
+#define TB_TIMER_WHEEL_BITS 6
+#define TB_TIMER_WHEEL_SLOTS (1 << TB_TIMER_WHEEL_BITS)
+#define TB_TIMER_WHEEL_LEVELS 6
+#define TB_TIMER_WHEEL_OVERFLOW TB_TIMER_WHEEL_LEVELS // Level of the overflow list (slot 0)
+
+struct tb_timer_wheel_s
+{
+    bs_time_t now;                                                  // Time the wheel has been advanced to
+    uint64_t occupied[TB_TIMER_WHEEL_LEVELS];                       // Bit mask of non-empty slots per level
+    tb_timer_t *slots[TB_TIMER_WHEEL_LEVELS + 1][TB_TIMER_WHEEL_SLOTS];
+    tb_timer_t *owned;                                              // Timers started by the context, running or not
+};
+
+static void tb_timer_wheel_insert(struct tb_timer_wheel_s *wheel, tb_timer_t *timer)
+{
+    uint64_t diff = timer->expiry ^ wheel->now;
+    unsigned int level = diff ? (63 - __builtin_clzll(diff)) / TB_TIMER_WHEEL_BITS : 0;
+    unsigned int slot = 0;
+
+    if (level >= TB_TIMER_WHEEL_LEVELS)
+        level = TB_TIMER_WHEEL_OVERFLOW;
+    else
+    {
+        slot = (timer->expiry >> (level * TB_TIMER_WHEEL_BITS)) & (TB_TIMER_WHEEL_SLOTS - 1);
+        wheel->occupied[level] |= 1ULL << slot;
+    }
+    timer->level = level;
+    timer->slot = slot;
+    timer->prev = NULL;
+    timer->next = wheel->slots[level][slot];
+    if (timer->next)
+        timer->next->prev = timer;
+    wheel->slots[level][slot] = timer;
+    timer->is_in_wheel = true;
+}
+
+static void tb_timer_wheel_remove(struct tb_timer_wheel_s *wheel, tb_timer_t *timer)
+{
+    if (timer->prev)
+        timer->prev->next = timer->next;
+    else
+        wheel->slots[timer->level][timer->slot] = timer->next;
+    if (timer->next)
+        timer->next->prev = timer->prev;
+    if (timer->level != TB_TIMER_WHEEL_OVERFLOW && wheel->slots[timer->level][timer->slot] == NULL)
+        wheel->occupied[timer->level] &= ~(1ULL << timer->slot);
+    timer->is_in_wheel = false;
+}
+
+// Start time of the specified slot in the current block of its level
+static bs_time_t tb_timer_wheel_slot_start(const struct tb_timer_wheel_s *wheel, unsigned int level, unsigned int slot)
+{
+    uint64_t block_mask = (1ULL << ((level + 1) * TB_TIMER_WHEEL_BITS)) - 1;
+    return (wheel->now & ~block_mask) | ((uint64_t)slot << (level * TB_TIMER_WHEEL_BITS));
+}
+
+// Advances the wheel to the specified time, removing the timers which have expired, and cascading the others from the
+// passed slots down to the lower levels.
+static void tb_timer_wheel_advance(struct tb_timer_wheel_s *wheel, bs_time_t time)
+{
+    tb_timer_t *list;
+
+    while (true)
+    {
+        unsigned int level;
+        unsigned int slot;
+        for (level = 0; level < TB_TIMER_WHEEL_LEVELS && wheel->occupied[level] == 0; level++);
+        if (level == TB_TIMER_WHEEL_LEVELS)
+            break;
+        slot = __builtin_ctzll(wheel->occupied[level]);
+        if (tb_timer_wheel_slot_start(wheel, level, slot) > time)
+            break;
+        wheel->now = tb_timer_wheel_slot_start(wheel, level, slot);
+        list = wheel->slots[level][slot];
+        wheel->slots[level][slot] = NULL;
+        wheel->occupied[level] &= ~(1ULL << slot);
+        while (list)
+        {
+            tb_timer_t *timer = list;
+            list = timer->next;
+            timer->is_in_wheel = false;
+            if (timer->expiry > time)
+                tb_timer_wheel_insert(wheel, timer);
+        }
+    }
+    if (time > wheel->now)
+        wheel->now = time;
+
+    list = wheel->slots[TB_TIMER_WHEEL_OVERFLOW][0];
+    wheel->slots[TB_TIMER_WHEEL_OVERFLOW][0] = NULL;
+    while (list)
+    {
+        tb_timer_t *timer = list;
+        list = timer->next;
+        timer->is_in_wheel = false;
+        if (timer->expiry > time)
+            tb_timer_wheel_insert(wheel, timer);
+    }
+}
+
+// Stops all timers owned by the context of the wheel, including those that have expired, and gives up their ownership
+static void tb_timer_wheel_release(struct tb_timer_wheel_s *wheel)
+{
+    tb_timer_t *next;
+
+    for (tb_timer_t *timer = wheel->owned; timer; timer = next)
+    {
+        next = timer->next_owned;
+        timer->expiry = TIME_NEVER;
+        timer->is_in_wheel = false;
+        timer->wheel = NULL;
+        timer->next_owned = NULL;
+    }
+    wheel->owned = NULL;
+}
+
+static bs_time_t tb_timer_wheel_next_expiry(const struct tb_timer_wheel_s *wheel)
+{
+    bs_time_t next_expiry = TIME_NEVER;
+    const tb_timer_t *timer = wheel->slots[TB_TIMER_WHEEL_OVERFLOW][0];
+
+    for (unsigned int level = 0; level < TB_TIMER_WHEEL_LEVELS; level++)
+    {
+        if (wheel->occupied[level])
+        {
+            timer = wheel->slots[level][__builtin_ctzll(wheel->occupied[level])];
+            break;
+        }
+    }
+    for (; timer; timer = timer->next)
+        if (timer->expiry < next_expiry)
+            next_expiry = timer->expiry;
+    return next_expiry;
+}
+
+// Only while the sequence is waiting for a condition can a timer expiry affect it, so only then is the ticker also
+// programmed for the earliest timer expiry. The earliest TB_CALL_W_DEADLINE deadline always applies.
+static void tb_program_ticker(tb_context_t *context, bs_time_t time)
+{
+    context->nbr_ticker_programs++;
+    if (context->call_deadline < time)
+        time = context->call_deadline;
+    if (context->timer_wheel && context->is_waiting_for_cond)
+    {
+        bs_time_t next_expiry;
+        tb_timer_wheel_advance(context->timer_wheel, tm_get_hw_time());
+        next_expiry = tb_timer_wheel_next_expiry(context->timer_wheel);
+        if (next_expiry < time)
+            time = next_expiry;
+    }
+    if (context->ticker)
+        context->ticker->set_next_tick_absolute(context->ticker->arg, time);
+    else
+        bst_ticker_set_next_tick_absolute(time);
+}
+
+void tb_set_next_tick(tb_context_t *context, bs_time_t time)
+{
+    context->next_tick_time = time;
+    // A pending deferred signal keeps the ticker at the current time; the tick is restored by tb_resume_on_event()
+    if (context->defer_signals && context->non_time_event_occurred)
+        return;
+    tb_program_ticker(context, time);
+}
+
+void tb_signal_event(tb_context_t *context, tb_tick_handler_t tick_handler)
+{
+    context->nbr_signals++;
+    // A sequence not entered yet waits for nothing; a deferred re-entry could even displace its first tick, programmed
+    // by the test bench itself
+    if (!context->is_started)
+        return;
+    if (!context->defer_signals)
+    {
+        context->non_time_event_occurred = true;
+        tick_handler(tm_get_hw_time());
+    }
+    else if (!context->non_time_event_occurred)
+    {
+        // First signal at this time: schedule a single re-entry after the current event processing
+        context->non_time_event_occurred = true;
+        tb_program_ticker(context, tm_get_hw_time());
+    }
+}
+
+// Called by TB_BEGIN when the tick handler is entered due to TB_SIGNAL_EVENT. Returns true if the sequence shall resume,
+// i.e. if it is waiting for a condition or (in deferred mode) if its time tick is also due now.
+bool tb_resume_on_event(tb_context_t *context)
+{
+    context->non_time_event_occurred = false;
+    context->nbr_signal_entries++;
+    if (context->defer_signals)
+    {
+        if (context->next_tick_time <= tm_get_hw_time())
+        {
+            context->next_tick_time = TIME_NEVER;
+            return true;
+        }
+        // Restore the time tick displaced by the deferred signal
+        if (context->next_tick_time != TIME_NEVER || context->timer_wheel || context->call_deadline_mask)
+            tb_program_ticker(context, context->next_tick_time);
+    }
+    return context->is_waiting_for_cond;
+}
+
+void tb_timer_start(tb_context_t *context, tb_timer_t *timer, bs_time_t expiry)
+{
+    if (context->timer_wheel == NULL)
+    {
+        context->timer_wheel = calloc(1, sizeof(struct tb_timer_wheel_s));
+        if (context->timer_wheel == NULL)
+            tb_assert_failed(__FILE__, __LINE__, "TB_ASSERT failed: Out of memory for timer wheel\n");
+        context->timer_wheel->now = tm_get_hw_time();
+    }
+    if (timer->is_in_wheel)
+        tb_timer_wheel_remove(timer->wheel, timer);
+    if (timer->wheel != context->timer_wheel)
+    {
+        // Not owned yet, or owned by another context (which cannot reset it any longer)
+        if (timer->wheel)
+        {
+            tb_timer_t **owned = &timer->wheel->owned;
+            while (*owned != timer)
+                owned = &(*owned)->next_owned;
+            *owned = timer->next_owned;
+        }
+        timer->wheel = context->timer_wheel;
+        timer->next_owned = context->timer_wheel->owned;
+        context->timer_wheel->owned = timer;
+    }
+    timer->expiry = expiry;
+    tb_timer_wheel_insert(context->timer_wheel, timer);
+    // Started by an event handler while the sequence is waiting
+    if (context->is_waiting_for_cond)
+        tb_timers_update(context);
+}
+
+void tb_timer_stop(tb_context_t *context, tb_timer_t *timer)
+{
+    if (timer->is_in_wheel)
+        tb_timer_wheel_remove(timer->wheel, timer);
+    timer->expiry = TIME_NEVER;
+}
+
+// Reprograms the ticker after the timers or the waiting state of the sequence have changed
+void tb_timers_update(tb_context_t *context)
+{
+    // A pending deferred signal keeps the ticker at the current time; the tick is restored by tb_resume_on_event()
+    if (context->defer_signals && context->non_time_event_occurred)
+        return;
+    tb_program_ticker(context, context->next_tick_time);
+}
+
+double tb_signal_coalescing_ratio(const tb_context_t *context)
+{
+    return context->nbr_signal_entries ? (double)context->nbr_signals / context->nbr_signal_entries : 1.0;
+}
+
+static uint64_t tb_wall_time_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+void tb_run_summary_start(tb_context_t *context)
+{
+    context->start_time = tm_get_hw_time();
+    context->start_wall_ns = tb_wall_time_ns();
+}
+
+void tb_run_summary(const tb_context_t *context, const char *print_prefix)
+{
+    struct rusage usage;
+    uint64_t sim_us = tm_get_hw_time() - context->start_time;
+    uint64_t wall_us = (tb_wall_time_ns() - context->start_wall_ns) / 1000;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        usage.ru_maxrss = 0;
+    bs_trace_raw_time(3, "%sTB_RUN_SUMMARY entries=%u time_ticks=%u signal_entries=%u signals=%u loop_ticks=%u "
+        "ticker_programs=%u sim_us=%llu wall_us=%llu sim_per_wall=%.1f peak_rss_kb=%ld\n", print_prefix,
+        context->nbr_entries, context->nbr_entries - context->nbr_signal_entries, context->nbr_signal_entries,
+        context->nbr_signals, context->nbr_loop_ticks, context->nbr_ticker_programs, (unsigned long long)sim_us,
+        (unsigned long long)wall_us, wall_us ? (double)sim_us / wall_us : 0.0, (long)usage.ru_maxrss);
+}
+
+static void tb_tick_mux_swap(tb_tick_mux_t *mux, unsigned int i, unsigned int j)
+{
+    tb_mux_ticker_t *mux_ticker = mux->heap[i];
+    mux->heap[i] = mux->heap[j];
+    mux->heap[j] = mux_ticker;
+    mux->heap[i]->heap_idx = i;
+    mux->heap[j]->heap_idx = j;
+}
+
+// Restores the heap order after the next tick time of the virtual ticker at the specified position has changed
+static void tb_tick_mux_sift(tb_tick_mux_t *mux, unsigned int i)
+{
+    while (i > 0 && mux->heap[i]->next_tick_time < mux->heap[(i - 1) / 2]->next_tick_time)
+    {
+        tb_tick_mux_swap(mux, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+    while (true)
+    {
+        unsigned int smallest = i;
+        unsigned int child = 2 * i + 1;
+        if (child < mux->nbr_tickers && mux->heap[child]->next_tick_time < mux->heap[smallest]->next_tick_time)
+            smallest = child;
+        if (child + 1 < mux->nbr_tickers && mux->heap[child + 1]->next_tick_time < mux->heap[smallest]->next_tick_time)
+            smallest = child + 1;
+        if (smallest == i)
+            return;
+        tb_tick_mux_swap(mux, i, smallest);
+        i = smallest;
+    }
+}
+
+static void tb_tick_mux_program(tb_tick_mux_t *mux)
+{
+    bs_time_t time = mux->nbr_tickers ? mux->heap[0]->next_tick_time : TIME_NEVER;
+    if (mux->is_dispatching || time == mux->programmed_time)
+        return;
+    mux->programmed_time = time;
+    if (mux->ticker)
+        mux->ticker->set_next_tick_absolute(mux->ticker->arg, time);
+    else
+        bst_ticker_set_next_tick_absolute(time);
+}
+
+void tb_tick_mux_add(tb_tick_mux_t *mux, tb_mux_ticker_t *mux_ticker, tb_tick_handler_t tick_handler)
+{
+    if (mux->nbr_tickers == TB_TICK_MUX_MAX_TICKERS)
+        tb_assert_failed(__FILE__, __LINE__, "TB_ASSERT failed: More than %d tickers added to tick multiplexer\n",
+            TB_TICK_MUX_MAX_TICKERS);
+    mux_ticker->ticker.set_next_tick_absolute = tb_tick_mux_set_next_tick;
+    mux_ticker->ticker.arg = mux_ticker;
+    mux_ticker->tick_handler = tick_handler;
+    mux_ticker->mux = mux;
+    mux_ticker->heap_idx = mux->nbr_tickers;
+    mux->heap[mux->nbr_tickers++] = mux_ticker;
+    tb_tick_mux_set_next_tick(mux_ticker, tm_get_hw_time());
+}
+
+void tb_tick_mux_set_next_tick(void *arg, bs_time_t time)
+{
+    tb_mux_ticker_t *mux_ticker = arg;
+    mux_ticker->next_tick_time = time;
+    tb_tick_mux_sift(mux_ticker->mux, mux_ticker->heap_idx);
+    tb_tick_mux_program(mux_ticker->mux);
+}
+
+void tb_tick_mux_dispatch(tb_tick_mux_t *mux, bs_time_t time)
+{
+    // The device ticker has fired (or the device's tick handler was called for some other reason)
+    mux->programmed_time = TIME_NEVER;
+    mux->is_dispatching = true;
+    while (mux->nbr_tickers && mux->heap[0]->next_tick_time <= time)
+    {
+        tb_mux_ticker_t *mux_ticker = mux->heap[0];
+        mux_ticker->next_tick_time = TIME_NEVER;
+        tb_tick_mux_sift(mux, 0);
+        mux_ticker->tick_handler(time);
+    }
+    mux->is_dispatching = false;
+    tb_tick_mux_program(mux);
+}
+
+// Order of the heap of a batch. Instances due at the same time are stepped grouped by resume point (of the top level
+// sequence), so that they take the same path through the code one after the other.
+static bool tb_batch_is_before(const tb_batch_heap_node_t *a, const tb_batch_heap_node_t *b)
+{
+    return a->time < b->time || (a->time == b->time && a->order < b->order);
+}
+
+// Restores the heap order after the key of the node at the specified position has changed. The node is moved into
+// place through a hole, instead of by swaps.
+static void tb_batch_sift(tb_batch_t *batch, unsigned int i)
+{
+    tb_batch_heap_node_t node = batch->heap[i];
+    while (i > 0 && tb_batch_is_before(&node, &batch->heap[(i - 1) / 2]))
+    {
+        batch->heap[i] = batch->heap[(i - 1) / 2];
+        batch->heap_idxs[(uint32_t)batch->heap[i].order] = i;
+        i = (i - 1) / 2;
+    }
+    while (2 * i + 1 < batch->nbr_instances)
+    {
+        unsigned int child = 2 * i + 1;
+        if (child + 1 < batch->nbr_instances && tb_batch_is_before(&batch->heap[child + 1], &batch->heap[child]))
+            child++;
+        if (!tb_batch_is_before(&batch->heap[child], &node))
+            break;
+        batch->heap[i] = batch->heap[child];
+        batch->heap_idxs[(uint32_t)batch->heap[i].order] = i;
+        i = child;
+    }
+    batch->heap[i] = node;
+    batch->heap_idxs[(uint32_t)node.order] = i;
+}
+
+static void tb_batch_program(tb_batch_t *batch)
+{
+    bs_time_t time = batch->nbr_instances ? batch->heap[0].time : TIME_NEVER;
+    if (batch->is_dispatching || time == batch->programmed_time)
+        return;
+    batch->programmed_time = time;
+    if (batch->ticker)
+        batch->ticker->set_next_tick_absolute(batch->ticker->arg, time);
+    else
+        bst_ticker_set_next_tick_absolute(time);
+}
+
+void tb_batch_init(tb_batch_t *batch, unsigned int nbr_instances, void (*func)(tb_context_t *context),
+    const tb_ticker_t *ticker, tb_tick_handler_t tick_handler, const tb_context_t *initial_context,
+    const char *print_prefix)
+{
+    batch->ticker = ticker;
+    batch->func = func;
+    batch->nbr_instances = nbr_instances;
+    batch->next_tick_times = calloc(nbr_instances, sizeof(bs_time_t));
+    batch->resume_points = calloc((size_t)nbr_instances * TB_MAX_CALL_DEPTH, sizeof(tb_resume_point_t));
+    batch->contexts = calloc(nbr_instances, sizeof(tb_context_t));
+    batch->tickers = calloc(nbr_instances, sizeof(tb_batch_ticker_t));
+    batch->heap = calloc(nbr_instances, sizeof(tb_batch_heap_node_t));
+    batch->heap_idxs = calloc(nbr_instances, sizeof(unsigned int));
+    batch->stepped_instance = nbr_instances;
+    batch->programmed_time = TIME_NEVER;
+    batch->is_dispatching = false;
+    if (nbr_instances && (batch->next_tick_times == NULL || batch->resume_points == NULL ||
+        batch->contexts == NULL || batch->tickers == NULL || batch->heap == NULL || batch->heap_idxs == NULL))
+    {
+        tb_batch_free(batch);
+        tb_assert_failed(__FILE__, __LINE__, "%sTB_ASSERT failed: Out of memory for %u batch instances\n",
+            print_prefix, nbr_instances);
+        return;
+    }
+    for (unsigned int i = 0; i < nbr_instances; i++)
+    {
+        tb_context_t *context = &batch->contexts[i];
+        batch->tickers[i].ticker.set_next_tick_absolute = tb_batch_set_next_tick;
+        batch->tickers[i].ticker.arg = &batch->tickers[i];
+        batch->tickers[i].batch = batch;
+        batch->tickers[i].instance = i;
+        *context = *initial_context;
+        context->tick_handler = tick_handler;
+        context->ticker = &batch->tickers[i].ticker;
+        // Signals between instances are then handled as steps of their own instead of recursively
+        context->defer_signals = true;
+        context->resume_points = &batch->resume_points[i];
+        context->resume_stride = nbr_instances;
+        context->instance = i;
+        batch->next_tick_times[i] = tm_get_hw_time();
+        // All due now at TB_BEGIN, so already in heap order
+        batch->heap[i].time = batch->next_tick_times[i];
+        batch->heap[i].order = i;
+        batch->heap_idxs[i] = i;
+    }
+    tb_batch_program(batch);
+}
+
+void tb_batch_free(tb_batch_t *batch)
+{
+    for (unsigned int i = 0; batch->contexts && i < batch->nbr_instances; i++)
+    {
+        if (batch->contexts[i].timer_wheel)
+            tb_timer_wheel_release(batch->contexts[i].timer_wheel);
+        free(batch->contexts[i].timer_wheel);
+        free(batch->contexts[i].checkpoint_log);
+    }
+    free(batch->next_tick_times);
+    free(batch->resume_points);
+    free(batch->contexts);
+    free(batch->tickers);
+    free(batch->heap);
+    free(batch->heap_idxs);
+    memset(batch, 0, sizeof(tb_batch_t));
+}
+
+void tb_batch_set_next_tick(void *arg, bs_time_t time)
+{
+    tb_batch_ticker_t *batch_ticker = arg;
+    tb_batch_t *batch = batch_ticker->batch;
+    unsigned int heap_idx = batch->heap_idxs[batch_ticker->instance];
+    batch->next_tick_times[batch_ticker->instance] = time;
+    // The node of the instance being stepped is updated when its step is done, as its resume point changes too
+    if (batch_ticker->instance == batch->stepped_instance)
+        return;
+    batch->heap[heap_idx].time = time;
+    tb_batch_sift(batch, heap_idx);
+    tb_batch_program(batch);
+}
+
+void tb_batch_dispatch(tb_batch_t *batch, bs_time_t time)
+{
+    // The device ticker has fired (or the device's tick handler was called for some other reason)
+    batch->programmed_time = TIME_NEVER;
+    batch->is_dispatching = true;
+    while (batch->nbr_instances && batch->heap[0].time <= time)
+    {
+        unsigned int i = (uint32_t)batch->heap[0].order;
+        tb_batch_heap_node_t *node;
+        // Its node keeps the old key while stepped; signals to the other instances sift their nodes meanwhile
+        batch->stepped_instance = i;
+        batch->next_tick_times[i] = TIME_NEVER;
+        batch->func(&batch->contexts[i]);
+        batch->stepped_instance = batch->nbr_instances;
+        node = &batch->heap[batch->heap_idxs[i]];
+        node->time = batch->next_tick_times[i];
+        node->order = (uint64_t)(uint32_t)batch->resume_points[i].line << 32 | i;
+        tb_batch_sift(batch, batch->heap_idxs[i]);
+    }
+    batch->is_dispatching = false;
+    tb_batch_program(batch);
+}
+
+void *tb_mailbox_reserve(tb_mailbox_t *mailbox, const char *print_prefix, const char *file, unsigned int line)
+{
+    if (mailbox == NULL)
+    {
+        tb_assert_failed(file, line, "%sTB_ASSERT failed: TB_MSG_RESERVE without TB_MAILBOX, or before the test "
+            "sequence was first entered (see TB_GLOBALS_W_MAILBOX)!\n", print_prefix);
+        return NULL;
+    }
+    if (mailbox->tail - mailbox->head == mailbox->capacity)
+    {
+        tb_assert_failed(file, line, "%sTB_ASSERT failed: TB_MAILBOX full (%u messages)!\n", print_prefix,
+            mailbox->capacity);
+        return NULL;
+    }
+    mailbox->is_slot_reserved = true;
+    return mailbox->slots + (mailbox->tail & (mailbox->capacity - 1)) * mailbox->slot_size;
+}
+
+void tb_mailbox_commit(tb_mailbox_t *mailbox, const char *print_prefix, const char *file, unsigned int line)
+{
+    if (mailbox == NULL || !mailbox->is_slot_reserved)
+    {
+        tb_assert_failed(file, line, "%sTB_ASSERT failed: TB_MSG_SEND without TB_MSG_RESERVE!\n", print_prefix);
+        return;
+    }
+    mailbox->is_slot_reserved = false;
+    mailbox->tail++;
+}
+
+void *tb_mailbox_next(tb_mailbox_t *mailbox, const char *print_prefix, const char *file, unsigned int line)
+{
+    if (mailbox == NULL)
+    {
+        tb_assert_failed(file, line, "%sTB_ASSERT failed: TB_MSG_NEXT or TB_WAIT_MSG without TB_MAILBOX!\n",
+            print_prefix);
+        return NULL;
+    }
+    tb_mailbox_release(mailbox, print_prefix, file, line);
+    if (mailbox->head == mailbox->tail)
+        return NULL;
+    mailbox->is_msg_held = true;
+    return mailbox->slots + (mailbox->head & (mailbox->capacity - 1)) * mailbox->slot_size;
+}
+
+void tb_mailbox_release(tb_mailbox_t *mailbox, const char *print_prefix, const char *file, unsigned int line)
+{
+    if (mailbox == NULL)
+    {
+        tb_assert_failed(file, line, "%sTB_ASSERT failed: TB_MSG_RELEASE without TB_MAILBOX!\n", print_prefix);
+        return;
+    }
+    if (mailbox->is_msg_held)
+    {
+        mailbox->is_msg_held = false;
+        mailbox->head++;
+    }
+}
+
+static void tb_sync_wait(tb_context_t *context, tb_waiter_list_t *waiters, const char *print_prefix,
+    const char *file, unsigned int line)
+{
+    if (context->tick_handler == NULL)
+        tb_assert_failed(file, line, "%sTB_ASSERT failed: Waiting for synchronization object without "
+            "TB_TICK_HANDLER!\n", print_prefix);
+    context->is_sync_granted = false;
+    context->next_waiter = NULL;
+    context->sync_waiters = waiters;
+    if (waiters->last)
+        waiters->last->next_waiter = context;
+    else
+        waiters->first = context;
+    waiters->last = context;
+}
+
+static void tb_sync_wake_first(tb_waiter_list_t *waiters)
+{
+    tb_context_t *context = waiters->first;
+    waiters->first = context->next_waiter;
+    if (waiters->first == NULL)
+        waiters->last = NULL;
+    context->next_waiter = NULL;
+    context->sync_waiters = NULL;
+    context->sync_nbr_arrived = NULL;
+    context->is_sync_granted = true;
+    tb_signal_event(context, context->tick_handler);
+}
+
+static void tb_sync_wake_all(tb_waiter_list_t *waiters)
+{
+    // Detach the list first, as woken contexts may start waiting for the same object again
+    tb_waiter_list_t woken = *waiters;
+    waiters->first = waiters->last = NULL;
+    while (woken.first)
+        tb_sync_wake_first(&woken);
+}
+
+void tb_sem_take(tb_context_t *context, tb_sem_t *sem, const char *print_prefix, const char *file, unsigned int line)
+{
+    if (sem->count > 0)
+    {
+        sem->count--;
+        context->is_sync_granted = true;
+    }
+    else
+        tb_sync_wait(context, &sem->waiters, print_prefix, file, line);
+}
+
+void tb_sem_give(tb_sem_t *sem)
+{
+    if (sem->waiters.first)
+        tb_sync_wake_first(&sem->waiters);
+    else
+        sem->count++;
+}
+
+void tb_event_wait(tb_context_t *context, tb_event_t *event, const char *print_prefix, const char *file,
+    unsigned int line)
+{
+    if (event->is_set)
+        context->is_sync_granted = true;
+    else
+        tb_sync_wait(context, &event->waiters, print_prefix, file, line);
+}
+
+void tb_event_set(tb_event_t *event)
+{
+    event->is_set = true;
+    tb_sync_wake_all(&event->waiters);
+}
+
+void tb_barrier_wait(tb_context_t *context, tb_barrier_t *barrier, const char *print_prefix, const char *file,
+    unsigned int line)
+{
+    if (++barrier->nbr_arrived < barrier->nbr_parties)
+    {
+        tb_sync_wait(context, &barrier->waiters, print_prefix, file, line);
+        context->sync_nbr_arrived = &barrier->nbr_arrived;
+        return;
+    }
+    barrier->nbr_arrived = 0;
+    context->is_sync_granted = true;
+    tb_sync_wake_all(&barrier->waiters);
+}
+
+// Withdraws the context from the synchronization object it is waiting for, when its wait is aborted
+static void tb_sync_cancel(tb_context_t *context)
+{
+    tb_waiter_list_t *waiters = context->sync_waiters;
+    tb_context_t *prev = NULL;
+
+    for (tb_context_t *waiter = waiters->first; waiter; prev = waiter, waiter = waiter->next_waiter)
+    {
+        if (waiter != context)
+            continue;
+        if (prev)
+            prev->next_waiter = waiter->next_waiter;
+        else
+            waiters->first = waiter->next_waiter;
+        if (waiters->last == waiter)
+            waiters->last = prev;
+        break;
+    }
+    if (context->sync_nbr_arrived)
+        (*context->sync_nbr_arrived)--;
+    context->next_waiter = NULL;
+    context->sync_waiters = NULL;
+    context->sync_nbr_arrived = NULL;
+}
+
+void tb_watch_wait(tb_context_t *context, tb_waiter_list_t *waiters, const char *print_prefix, const char *file,
+    unsigned int line)
+{
+    tb_sync_wait(context, waiters, print_prefix, file, line);
+}
+
+// The context is in the waiter list of the watched variable only while the condition is false, so that it is woken by
+// the next change of the variable, but stays out of the list once done waiting.
+bool tb_watch_cond(tb_context_t *context, tb_waiter_list_t *waiters, bool cond, const char *print_prefix,
+    const char *file, unsigned int line)
+{
+    bool is_waiting = context->sync_waiters == waiters;
+    if (cond)
+    {
+        // Also true after a wait for other reasons, e.g. a TB_SIGNAL_EVENT
+        if (is_waiting)
+            tb_sync_cancel(context);
+        return true;
+    }
+    if (!is_waiting)
+        tb_sync_wait(context, waiters, print_prefix, file, line);
+    return false;
+}
+
+void tb_watch_changed(tb_waiter_list_t *waiters)
+{
+    tb_sync_wake_all(waiters);
+}
+
+static void tb_call_deadline_update(tb_context_t *context)
+{
+    context->call_deadline = TIME_NEVER;
+    for (unsigned int depth = 0; depth < TB_MAX_CALL_DEPTH; depth++)
+        if ((context->call_deadline_mask & (1u << depth)) && context->call_deadlines[depth] < context->call_deadline)
+            context->call_deadline = context->call_deadlines[depth];
+}
+
+void tb_call_deadline_begin(tb_context_t *context, bs_time_t deadline, const char *print_prefix, const char *file,
+    unsigned int line)
+{
+    // The sequences called must have run ids of their own, to be reset at an abort
+    if (context->call_depth >= TB_MAX_CALL_DEPTH - 1)
+    {
+        tb_assert_failed(file, line, "%sTB_ASSERT failed: TB_CALL_W_DEADLINE nested more than %d TB_CALLs deep\n",
+            print_prefix, TB_MAX_CALL_DEPTH - 2);
+        return;
+    }
+    context->call_deadlines[context->call_depth] = deadline;
+    context->call_deadline_mask |= 1u << context->call_depth;
+    context->is_call_timed_out = false;
+    tb_call_deadline_update(context);
+    tb_timers_update(context);
+}
+
+void tb_call_deadline_end(tb_context_t *context)
+{
+    context->call_deadline_mask &= ~(1u << context->call_depth);
+    context->is_call_timed_out = false;
+    tb_call_deadline_update(context);
+    // The ticker may still be programmed for the deadline
+    tb_timers_update(context);
+}
+
+// Called by TB_CALL_W_DEADLINE at its deadline. Giving all deeper call depths a fresh run id makes the called function,
+// and the functions it has called in turn, start over from TB_BEGIN when called again.
+void tb_call_abort(tb_context_t *context)
+{
+    unsigned int fresh_run_id = ++context->call_epoch;
+    for (unsigned int depth = context->call_depth + 1; depth < TB_MAX_CALL_DEPTH; depth++)
+        context->call_run_ids[depth] = fresh_run_id;
+    // The deadlines of this and of the aborted TB_CALL_W_DEADLINEs end
+    context->call_deadline_mask &= (1u << context->call_depth) - 1;
+    tb_call_deadline_update(context);
+    if (context->sync_waiters)
+        tb_sync_cancel(context);
+    context->is_sync_granted = false;
+    context->is_waiting_for_cond = false;
+    context->waiting_deadline = TIME_NEVER;
+    context->is_func_done = false;
+    context->is_call_timed_out = true;
+    tb_set_next_tick(context, TIME_NEVER);
+}
+
+void tb_rand_seed(tb_context_t *context, uint64_t seed)
+{
+    // Expand the seed with splitmix64, which never yields the invalid all zero state
+    for (int i = 0; i < 4; i++)
+    {
+        uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        context->rand_state[i] = z ^ (z >> 31);
+    }
+}
+
+// xoshiro256** by David Blackman and Sebastiano Vigna
+uint64_t tb_rand(tb_context_t *context)
+{
+    uint64_t *s = context->rand_state;
+    if ((s[0] | s[1] | s[2] | s[3]) == 0)
+        tb_rand_seed(context, 0);
+    uint64_t result = tb_rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = tb_rotl(s[3], 45);
+    return result;
+}
+
+bs_time_t tb_rand_range(tb_context_t *context, bs_time_t min, bs_time_t max)
+{
+    bs_time_t range = max - min + 1;
+    return range ? min + tb_rand(context) % range : tb_rand(context);
+}
+
+bs_time_t tb_rand_jitter(tb_context_t *context, bs_time_t delay, unsigned int pct)
+{
+    bs_time_t jitter = delay * pct / 100;
+    return tb_rand_range(context, jitter < delay ? delay - jitter : 0, delay + jitter);
+}
+
+void tb_restart(tb_context_t *context)
+{
+    context->is_waiting_for_cond = false;
+    context->non_time_event_occurred = false;
+    context->waiting_deadline = TIME_NEVER;
+    context->poll_period = context->poll_max_period = 0;
+    context->is_func_done = false;
+    context->checkpoint_idx = 0;
+    if (context->checkpoint_log)
+        context->checkpoint_log->nbr = 0;
+    context->buf_checkpoint_idx = 0;
+    context->next_tick_time = TIME_NEVER;
+    context->nbr_signals = 0;
+    context->nbr_signal_entries = 0;
+    context->is_started = false;
+    context->nbr_entries = 0;
+    context->nbr_loop_ticks = 0;
+    context->nbr_ticker_programs = 0;
+    if (context->sync_waiters)
+        tb_sync_cancel(context);
+    context->next_waiter = NULL;
+    context->is_sync_granted = false;
+    context->sync_waiters = NULL;
+    context->sync_nbr_arrived = NULL;
+    context->call_depth = 0;
+    context->call_deadline_mask = 0;
+    context->call_deadline = TIME_NEVER;
+    context->is_call_timed_out = false;
+    memset(context->rand_state, 0, sizeof(context->rand_state));
+    if (context->mailbox)
+    {
+        context->mailbox->head = context->mailbox->tail = 0;
+        context->mailbox->is_slot_reserved = context->mailbox->is_msg_held = false;
+    }
+    if (context->timer_wheel)
+    {
+        tb_timer_wheel_release(context->timer_wheel);
+        // Time 0, as the simulation time may also be restarted
+        memset(context->timer_wheel, 0, sizeof(struct tb_timer_wheel_s));
+    }
+    // Makes TB_BEGIN of the test sequence and all sub-test sequences start over, and the TB_LOCALs re-initialized
+    context->call_epoch++;
+    for (unsigned int depth = 0; depth < TB_MAX_CALL_DEPTH; depth++)
+        context->call_run_ids[depth] = context->call_epoch;
+    context->run_id++;
+    if (context->finish_status != TB_FINISH_PENDING && context->is_finish_registered)
+        tb_finish_nbr_pending++;
+    context->finish_status = TB_FINISH_PENDING;
+}
+
+void tb_finish_register(tb_context_t *context)
+{
+    if (context->is_finish_registered)
+        return;
+    context->is_finish_registered = true;
+    context->next_finish_context = tb_finish_contexts;
+    tb_finish_contexts = context;
+    if (context->finish_status == TB_FINISH_PENDING)
+        tb_finish_nbr_pending++;
+}
+
+void tb_finish_set_hook(void (*hook)(bool passed))
+{
+    tb_finish_hook = hook;
+}
+
+void tb_finish(tb_context_t *context, bool passed, const char *print_prefix, const char *file, unsigned int line)
+{
+    bool all_passed = true;
+
+    if (context->finish_status != TB_FINISH_PENDING)
+    {
+        tb_assert_failed(file, line, "%sTB_ASSERT failed: TB_FINISH of a finished test bench context\n", print_prefix);
+        return;
+    }
+    tb_checkpoints_verify(context, print_prefix);
+    tb_finish_register(context);
+    context->finish_status = passed ? TB_FINISH_PASSED : TB_FINISH_FAILED;
+    tb_finish_nbr_pending--;
+    bs_trace_raw_time(3, "%sTest bench finished: %s (line %u)\n", print_prefix, passed ? "PASSED" : "FAILED", line);
+    if (tb_finish_nbr_pending > 0)
+        return;
+    for (tb_context_t *finished = tb_finish_contexts; finished; finished = finished->next_finish_context)
+        all_passed = all_passed && finished->finish_status == TB_FINISH_PASSED;
+    if (tb_finish_hook)
+        tb_finish_hook(all_passed);
+    else if (all_passed)
+        bs_trace_print(BS_TRACE_EXIT, file, line, 0, BS_TRACE_TIME_PROVIDED, tm_get_hw_time(),
+            "%sAll test bench contexts finished: PASSED\n", print_prefix);
+    else
+        bs_trace_print(BS_TRACE_ERROR, file, line, 0, BS_TRACE_TIME_PROVIDED, tm_get_hw_time(),
+            "%sAll test bench contexts finished: FAILED\n", print_prefix);
+}
+
+// Runs the test once per item (seed or table row) back-to-back, restarting the context before each run. A failing
+// TB_ASSERT or TB_CHECKPOINT ends the run instead of the process. Returns the number of failing items.
+static unsigned int tb_run_items(tb_context_t *context, const char *caller, const char *item_name,
+    uint64_t first_item, unsigned int nbr_items, bool seed_items, bool (*run)(uint64_t item), uint64_t *failing_items,
+    unsigned int max_failing_items)
+{
+    jmp_buf failure_jmp_buf;
+    unsigned int nbr_failing_items = 0;
+    clock_t start = clock();
+
+    for (unsigned int i = 0; i < nbr_items; i++)
+    {
+        uint64_t item = first_item + i;
+        bool passed;
+
+        tb_restart(context);
+        if (seed_items)
+            tb_rand_seed(context, item);
+        tb_sweep_failure_msg[0] = '\0';
+        tb_sweep_failure_jmp_buf = &failure_jmp_buf;
+        if (setjmp(failure_jmp_buf) == 0)
+            passed = run(item);
+        else
+            passed = false;
+        tb_sweep_failure_jmp_buf = NULL;
+
+        if (!passed)
+        {
+            printf("%s: %s %llu failed: %s%s", caller, item_name, (unsigned long long)item,
+                tb_sweep_failure_msg[0] ? tb_sweep_failure_msg : "test did not pass",
+                tb_sweep_failure_msg[0] && tb_sweep_failure_msg[strlen(tb_sweep_failure_msg) - 1] == '\n' ? "" : "\n");
+            if (nbr_failing_items < max_failing_items)
+                failing_items[nbr_failing_items] = item;
+            nbr_failing_items++;
+        }
+    }
+    printf("%s: %u of %u %ss failed (%.0f %ss/s)\n", caller, nbr_failing_items, nbr_items, item_name,
+        nbr_items / ((double)(clock() - start) / CLOCKS_PER_SEC + 1e-9), item_name);
+    return nbr_failing_items;
+}
+
+unsigned int tb_seed_sweep(tb_context_t *context, uint64_t first_seed, unsigned int nbr_seeds,
+    bool (*run)(uint64_t seed), uint64_t *failing_seeds, unsigned int max_failing_seeds)
+{
+    return tb_run_items(context, "tb_seed_sweep", "seed", first_seed, nbr_seeds, true, run, failing_seeds,
+        max_failing_seeds);
+}
+
+// The run function of the table being run by tb_run_table()
+static bool (*tb_run_table_row_func)(unsigned int row);
+
+static bool tb_run_table_row(uint64_t row)
+{
+    return tb_run_table_row_func(row);
+}
+
+unsigned int tb_run_table(tb_context_t *context, unsigned int nbr_rows, bool (*run)(unsigned int row),
+    uint64_t *failing_rows, unsigned int max_failing_rows)
+{
+    tb_run_table_row_func = run;
+    return tb_run_items(context, "tb_run_table", "row", 0, nbr_rows, false, tb_run_table_row, failing_rows,
+        max_failing_rows);
+}
+
+bool tb_parse_seed_arg(const char *arg, uint64_t *first_seed, unsigned int *nbr_seeds)
+{
+    char *end;
+    if (strncmp(arg, "-tb_seed=", 9) == 0)
+    {
+        *first_seed = strtoull(arg + 9, &end, 0);
+        *nbr_seeds = 1;
+        return *end == '\0';
+    }
+    if (strncmp(arg, "-tb_seeds=", 10) == 0)
+    {
+        *first_seed = strtoull(arg + 10, &end, 0);
+        if (*end != ':')
+            return false;
+        *nbr_seeds = strtoul(end + 1, &end, 0);
+        return *end == '\0';
+    }
+    return false;
+}
+
+// Expansion points of all files compiled with TB_COVERAGE (see tb_cov_point_t); both are NULL if there are none
+extern tb_cov_point_t __start_tb_cov_points[] __attribute__ ((__weak__));
+extern tb_cov_point_t __stop_tb_cov_points[] __attribute__ ((__weak__));
+
+static void tb_cov_dump_at_exit(void)
+{
+    const char *path = getenv("TB_COVERAGE_FILE");
+    if (!tb_cov_dump(path ? path : "tb_coverage.cov"))
+        fprintf(stderr, "tb_cov: could not write coverage file %s\n", path ? path : "tb_coverage.cov");
+}
+
+static void __attribute__ ((__constructor__)) tb_cov_init(void)
+{
+    if (__stop_tb_cov_points - __start_tb_cov_points > 0)
+        atexit(tb_cov_dump_at_exit);
+}
+
+// Orders the points by file and line, and points on the same line by their order in the section
+static int tb_cov_point_cmp(const void *a, const void *b)
+{
+    const tb_cov_point_t *point_a = *(const tb_cov_point_t *const *)a;
+    const tb_cov_point_t *point_b = *(const tb_cov_point_t *const *)b;
+    int cmp = strcmp(point_a->file, point_b->file);
+    if (cmp == 0)
+        cmp = point_a->line != point_b->line ? (point_a->line > point_b->line ? 1 : -1) : 0;
+    if (cmp == 0)
+        cmp = point_a != point_b ? (point_a > point_b ? 1 : -1) : 0;
+    return cmp;
+}
+
+// Writes one line per file: the comma separated lines of its expansion points in ascending order, each followed by
+// '*' if reached (a line is repeated for each point on it), and the file name.
+bool tb_cov_dump(const char *path)
+{
+    size_t nbr_points = __stop_tb_cov_points - __start_tb_cov_points;
+    const tb_cov_point_t **points = malloc((nbr_points + 1) * sizeof(tb_cov_point_t *));
+    FILE *f = points ? fopen(path, "w") : NULL;
+    if (f == NULL)
+    {
+        free(points);
+        return false;
+    }
+    for (size_t i = 0; i < nbr_points; i++)
+        points[i] = &__start_tb_cov_points[i];
+    qsort(points, nbr_points, sizeof(tb_cov_point_t *), tb_cov_point_cmp);
+    fprintf(f, "tb_coverage 2\n");
+    for (size_t i = 0; i < nbr_points; i++)
+    {
+        bool is_last_of_file = i + 1 == nbr_points || strcmp(points[i]->file, points[i + 1]->file) != 0;
+        fprintf(f, "%u%s%s", points[i]->line, points[i]->is_reached ? "*" : "", is_last_of_file ? " " : ",");
+        if (is_last_of_file)
+            fprintf(f, "%s\n", points[i]->file);
+    }
+    free(points);
+    return fclose(f) == 0;
+}
+
+void tb_cov_clear(void)
+{
+    for (tb_cov_point_t *point = __start_tb_cov_points; point != __stop_tb_cov_points; point++)
+        point->is_reached = false;
+}
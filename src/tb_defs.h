@@ -38,14 +38,23 @@
 // the appropriate variables which are used in the condition, and call the time tick handler via TB_SIGNAL_EVENT).
 // Three other variants, TB_WAIT_COND_W_DEADLINE, TB_WAIT_COND_W_DEADLINE_DELTA, and TB_WAIT_COND_ASSERT wait for either
 // a condition to become true OR a certain absolute/relative time to occur/elapse, whichever happens first.
+// TB_WAIT_COND_POLL waits for a condition that no event signals (e.g. a register value in a peripheral model), by
+// re-checking it on a backoff schedule.
+//
+// Test sequences can also be loaded at run time from script files, and run with TB_SCRIPT (see tb_script.h).
 //
 // Usage examples can be found in the tb_defs_unit_test_main.c file which tests all these definitions.
 //
+// The slow paths of the macros (error reporting, wait bookkeeping) are implemented out of line in tb_defs.c, so test
+// benches must be linked with libtbdefs.a (built by "make compile").
+//
 // IMPORTANT: Always use statically allocated (e.g. file level) variables to store information that needs to survive
 //            the execution of TB_WAIT and the other macros. These macros close and open code blocks or exit and enter
 //            the tick handler function, so local stack variables will obviously not be preserved!
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 // Include the following header files in the c file before including this header file.
 //#include "bs_types.h"
 //#include "bs_tracing.h"
@@ -63,16 +72,240 @@ typedef struct
 } tb_checkpoint_t;
 
 typedef struct
+{
+    bs_time_t time;
+    uint64_t hash;              // XXH64 (seed 0) of the buffer contents
+} tb_buf_checkpoint_t;
+
+typedef void (*tb_tick_handler_t)(bs_time_t time);
+
+// Single-producer/single-consumer ring buffer of fixed-size messages from event handlers to the test sequence. The
+// head and tail indexes are free running, and each is only written by one side, so no locking is needed.
+typedef struct
+{
+    unsigned char *slots;
+    unsigned int slot_size;
+    unsigned int capacity;      // Number of slots; a power of two
+    unsigned int head;          // Index of the oldest message (written by the consumer only)
+    unsigned int tail;          // Index of the next free slot (written by the producer only)
+    bool is_slot_reserved;      // The producer has reserved the slot at tail
+    bool is_msg_held;           // The consumer holds the message at head
+} tb_mailbox_t;
+
+// Ticker through which a context schedules its time ticks, for contexts that do not use the device's BabbleSim ticker
+// (e.g. when several test bench contexts run in the same device)
+typedef struct
+{
+    void (*set_next_tick_absolute)(void *arg, bs_time_t time);
+    void *arg;
+} tb_ticker_t;
+
+#ifndef TB_TICK_MUX_MAX_TICKERS
+#define TB_TICK_MUX_MAX_TICKERS 16
+#endif
+
+// Virtual ticker of one tick handler sharing a device ticker through a tb_tick_mux_t
+typedef struct tb_mux_ticker_s
+{
+    tb_ticker_t ticker;                 // Given to TB_TICKER of the context of the tick handler
+    tb_tick_handler_t tick_handler;
+    bs_time_t next_tick_time;           // TIME_NEVER if none
+    struct tb_tick_mux_s *mux;
+    unsigned int heap_idx;              // Position in the min-heap of the multiplexer
+} tb_mux_ticker_t;
+
+// Multiplexer of the virtual tickers sharing one device ticker. The virtual tickers are kept in a min-heap on their
+// next tick time, so only the earliest is programmed into the device ticker, and only due tick handlers are called.
+typedef struct tb_tick_mux_s
+{
+    const tb_ticker_t *ticker;          // Device ticker; NULL if the device's BabbleSim ticker is used
+    tb_mux_ticker_t *heap[TB_TICK_MUX_MAX_TICKERS];
+    unsigned int nbr_tickers;
+    bs_time_t programmed_time;          // Time last programmed into the device ticker
+    bool is_dispatching;                // The device ticker is programmed once the dispatching is done
+} tb_tick_mux_t;
+
+struct tb_timer_wheel_s;
+struct tb_waiter_list_s;
+
+// Timer started by TB_TIMER_START. While running, it is kept in the timer wheel of the context that started it. It
+// stays owned by that context after expiring or being stopped, so that TB_RESET can stop it.
+typedef struct tb_timer_s
+{
+    bs_time_t expiry;           // TIME_NEVER if stopped
+    struct tb_timer_s *prev;    // Neighbours in the timer wheel slot
+    struct tb_timer_s *next;
+    unsigned char level;        // Timer wheel level and slot (if is_in_wheel)
+    unsigned char slot;
+    bool is_in_wheel;
+    struct tb_timer_wheel_s *wheel; // Timer wheel of the owning context (NULL if none)
+    struct tb_timer_s *next_owned; // Next timer owned by the same context
+} tb_timer_t;
+
+#ifndef TB_CHECKPOINT_LOG_SIZE
+#define TB_CHECKPOINT_LOG_SIZE 1024
+#endif
+
+// Checkpoints logged by TB_CHECKPOINT with TB_DEFER_CHECKPOINTS, not verified yet. The times and values are kept in
+// separate arrays, so that they are compared with the TB_CHECKPOINT_SEQ in one pass; the call sites are only read to
+// report a mismatch.
+typedef struct
+{
+    unsigned int nbr;
+    bs_time_t times[TB_CHECKPOINT_LOG_SIZE];
+    int vals[TB_CHECKPOINT_LOG_SIZE];
+    const char *files[TB_CHECKPOINT_LOG_SIZE];
+    unsigned int lines[TB_CHECKPOINT_LOG_SIZE];
+} tb_checkpoint_log_t;
+
+// Number of TB_CALL nesting depths with their own bookkeeping (at most 32). Plain TB_CALLs can be nested deeper, except
+// in the instances of a batch, which keep their resume points per depth. A TB_CALL_W_DEADLINE must be made from a depth
+// below TB_MAX_CALL_DEPTH - 1, as the sequences at the deeper depths share one run id (see tb_call_abort).
+#ifndef TB_MAX_CALL_DEPTH
+#define TB_MAX_CALL_DEPTH 16
+#endif
+
+typedef enum
+{
+    TB_FINISH_PENDING,                  // TB_FINISH not executed yet
+    TB_FINISH_PASSED,
+    TB_FINISH_FAILED,
+} tb_finish_status_t;
+
+// Point at which a (sub-)test sequence resumes. Kept in a static variable of the sequence function, or, for the
+// instances of a batch (see TB_BATCH_INIT), per instance and call depth.
+typedef struct
+{
+    int line;                           // 0 if at TB_BEGIN
+    unsigned int run_id;                // call_run_ids value the line belongs to
+} tb_resume_point_t;
+
+typedef struct tb_context_s
 {
     bool is_waiting_for_cond;
     bool non_time_event_occurred;
     bs_time_t waiting_deadline;
+    bs_time_t poll_period;              // Current re-check period of TB_WAIT_COND_POLL
+    bs_time_t poll_max_period;
     bool is_func_done;
     const tb_checkpoint_t *checkpoints;
     int nbr_checkpoints;
     int checkpoint_idx;
+    tb_checkpoint_log_t *checkpoint_log; // Allocated by the first TB_CHECKPOINT with TB_DEFER_CHECKPOINTS
+    bool defer_checkpoints;             // TB_DEFER_CHECKPOINTS, for checkpoints made by code built apart (e.g. scripts)
+    const tb_buf_checkpoint_t *buf_checkpoints;
+    int nbr_buf_checkpoints;
+    int buf_checkpoint_idx;
+    bool record_buf_checkpoints;        // TB_CHECKPOINT_BUF prints the buffers instead of checking them
+    tb_mailbox_t *mailbox;
+    bool defer_signals;                 // TB_SIGNAL_EVENT schedules one re-entry instead of calling the tick handler
+    bs_time_t next_tick_time;           // Time of the next time tick requested by the sequence (TIME_NEVER if none)
+    unsigned int nbr_signals;           // Number of TB_SIGNAL_EVENTs
+    unsigned int nbr_signal_entries;    // Number of tick handler entries caused by TB_SIGNAL_EVENTs
+    bool is_started;                    // The top level sequence has been entered (since the last TB_RESET)
+    unsigned int nbr_entries;           // Number of tick handler entries (of the top level sequence)
+    unsigned int nbr_loop_ticks;        // Number of ticks scheduled at the end of loop iterations
+    unsigned int nbr_ticker_programs;   // Number of times the ticker was programmed
+    bs_time_t start_time;               // Simulated time of the first tick handler entry
+    uint64_t start_wall_ns;             // Wall-clock time (monotonic) of the first tick handler entry
+    tb_tick_handler_t tick_handler;     // Set by TB_TICK_HANDLER
+    const tb_ticker_t *ticker;          // Set by TB_TICKER; NULL if the device's BabbleSim ticker is used
+    struct tb_context_s *next_waiter;   // Next context waiting for the same synchronization object
+    bool is_sync_granted;               // The synchronization object waited for has been taken/set/passed
+    uint64_t rand_state[4];             // State of the xoshiro256** generator used by TB_RAND and TB_WAIT_RAND/JITTER
+    unsigned int run_id;                // Incremented when the sequence is restarted; re-initializes the TB_LOCALs
+    unsigned int call_depth;            // TB_CALL nesting depth of the (sub-)test sequence being executed
+    unsigned int call_epoch;            // Source of fresh values for call_run_ids
+    unsigned int call_run_ids[TB_MAX_CALL_DEPTH]; // Changed to reset the resume points of the sequences at a depth;
+                                        // the last one is shared by all deeper depths (see TB_CALL_RUN_ID)
+    bs_time_t call_deadlines[TB_MAX_CALL_DEPTH]; // Deadline of the TB_CALL_W_DEADLINE made at each depth
+    uint32_t call_deadline_mask;        // Depths with a TB_CALL_W_DEADLINE in progress
+    bs_time_t call_deadline;            // Earliest deadline of the TB_CALL_W_DEADLINEs in progress
+    bool is_call_timed_out;             // The last TB_CALL_W_DEADLINE timed out
+    struct tb_waiter_list_s *sync_waiters; // Waiter list of the synchronization object waited for (NULL if none)
+    unsigned int *sync_nbr_arrived;     // Arrival count of the barrier waited for (NULL if none)
+    struct tb_timer_wheel_s *timer_wheel; // Running timers; allocated by the first TB_TIMER_START
+    tb_resume_point_t *resume_points;   // Resume points of the batch instance at call depth 0 (NULL if not in a batch)
+    unsigned int resume_stride;         // Distance between the resume points of the instance at consecutive depths
+    unsigned int instance;              // Index of the batch instance (0 if not in a batch)
+    tb_finish_status_t finish_status;   // Set by TB_FINISH
+    bool is_finish_registered;          // The run ends when all registered contexts are finished
+    struct tb_context_s *next_finish_context; // Next registered context
 } tb_context_t;
 
+// Contexts waiting for a synchronization object, in the order they started waiting
+typedef struct tb_waiter_list_s
+{
+    tb_context_t *first;
+    tb_context_t *last;
+} tb_waiter_list_t;
+
+typedef struct
+{
+    unsigned int count;
+    tb_waiter_list_t waiters;
+} tb_sem_t;
+
+typedef struct
+{
+    bool is_set;
+    tb_waiter_list_t waiters;
+} tb_event_t;
+
+typedef struct
+{
+    unsigned int nbr_parties;
+    unsigned int nbr_arrived;
+    tb_waiter_list_t waiters;
+} tb_barrier_t;
+
+// Node of the heap of a tb_batch_t. The sort key is kept in the node, so that sifting reads adjacent nodes only.
+typedef struct
+{
+    bs_time_t time;                     // Next tick time of the instance
+    uint64_t order;                     // Resume line (high half; as of the last step) and index of the instance
+} tb_batch_heap_node_t;
+
+// Virtual ticker of one instance of a tb_batch_t
+typedef struct
+{
+    tb_ticker_t ticker;                 // Used by the context of the instance
+    struct tb_batch_s *batch;
+    unsigned int instance;
+} tb_batch_ticker_t;
+
+// Batch of instances of one test sequence (e.g. one per simulated device of the same kind), sharing one device ticker.
+// The instances are kept in a min-heap on their next tick time and resume point (like the virtual tickers of a
+// tb_tick_mux_t), so the next instance to step is always at the top, without visiting the other instances' contexts.
+// The per-instance state is an array of complete contexts, not a structure of arrays; only the tick times, the resume
+// points, and the heap are kept in arrays of their own.
+typedef struct tb_batch_s
+{
+    const tb_ticker_t *ticker;          // Device ticker; NULL if the device's BabbleSim ticker is used
+    void (*func)(tb_context_t *context); // Test sequence of the instances
+    unsigned int nbr_instances;
+    bs_time_t *next_tick_times;         // Per instance: tick time set via its virtual ticker (TIME_NEVER if none)
+    tb_resume_point_t *resume_points;   // Per call depth and instance: [depth * nbr_instances + instance]
+    tb_context_t *contexts;             // Per instance
+    tb_batch_ticker_t *tickers;         // Per instance
+    tb_batch_heap_node_t *heap;         // Min-heap of the instances on next tick time, then resume point, then index
+    unsigned int *heap_idxs;            // Per instance: position in the heap
+    unsigned int stepped_instance;      // Instance being stepped by the dispatching (nbr_instances if none)
+    bs_time_t programmed_time;          // Time last programmed into the device ticker
+    bool is_dispatching;                // The device ticker is programmed once the dispatching is done
+} tb_batch_t;
+
+// Expansion point of a test sequence compiled with TB_COVERAGE. Each point is a static record placed in the
+// tb_cov_points linker section, so that the runtime knows all points of the test bench, reached or not. The records are
+// walked as an array between the linker generated __start_tb_cov_points and __stop_tb_cov_points, which is why the type
+// is aligned to its own (power of two) size: the compiler must not pad between them.
+typedef struct
+{
+    const char *file;       // __FILE__ of the expansion, i.e. the header file for sequences in included headers
+    unsigned int line;
+    bool is_reached;
+} __attribute__ ((__aligned__ (16))) tb_cov_point_t;
+
 typedef enum
 {
     TB_BLK_TYPE_IF,
@@ -95,29 +328,228 @@ typedef struct
 
 #define TB_MAX_BLK_LEVELS 64
 
-// Special values for tb_next_line when next line is unknown
+// Special values for the resume line of a sequence when the next line is unknown
 #define TB_END_LINE             -1 // Go to line following ENDIF/ENDFOR/ENDWHILE/UNTIL
 #define TB_ELSE_OR_ENDIF_LINE   -2 // Go to line following ELSE OR ENDIF - whichever comes first
 #define TB_LOOP_COND_LINE       -3 // Go to evaluation of loop condition (skip loop iteration expression)
 #define TB_LOOP_ITER_LINE       -4 // Go to end of loop before evaluation of iteration expression and loop condition,
                                    // i.e. point immediately before ENDFOR/ENDWHILE/UNTIL
 
+#define TB_COLD __attribute__ ((__cold__, __noinline__))
+
+// Out-of-line helpers implemented in tb_defs.c. Only to be used via the public macros below.
+#ifdef __cplusplus
+extern "C" {
+#endif
+void tb_assert_failed(const char *file, unsigned int line, const char *fmt_str, ...)
+    TB_COLD __attribute__ ((__format__ (__printf__, 3, 4)));
+void tb_checkpoint_failed(tb_context_t *context, int val, const char *print_prefix, const char *file,
+    unsigned int line) TB_COLD;
+void tb_checkpoint_log_full(tb_context_t *context, int val, const char *print_prefix, const char *file,
+    unsigned int line);
+void tb_checkpoints_verify(tb_context_t *context, const char *print_prefix);
+void tb_checkpoint_buf(tb_context_t *context, const void *data, size_t len, const char *print_prefix, const char *file,
+    unsigned int line);
+uint64_t tb_hash(const void *data, size_t len);
+void tb_wait_until_in_past(bs_time_t time, const char *print_prefix, const char *file, unsigned int line) TB_COLD;
+void tb_wait_cond_begin(tb_context_t *context, bs_time_t deadline);
+void tb_wait_cond_end(tb_context_t *context);
+void tb_wait_cond_poll_begin(tb_context_t *context, bs_time_t min_period, bs_time_t max_period, bs_time_t deadline);
+void tb_wait_cond_poll(tb_context_t *context);
+void tb_set_next_tick(tb_context_t *context, bs_time_t time);
+void tb_signal_event(tb_context_t *context, tb_tick_handler_t tick_handler);
+bool tb_resume_on_event(tb_context_t *context);
+double tb_signal_coalescing_ratio(const tb_context_t *context);
+void tb_run_summary_start(tb_context_t *context);
+void tb_run_summary(const tb_context_t *context, const char *print_prefix);
+void tb_tick_mux_add(tb_tick_mux_t *mux, tb_mux_ticker_t *mux_ticker, tb_tick_handler_t tick_handler);
+void tb_tick_mux_set_next_tick(void *arg, bs_time_t time);
+void tb_tick_mux_dispatch(tb_tick_mux_t *mux, bs_time_t time);
+void tb_batch_init(tb_batch_t *batch, unsigned int nbr_instances, void (*func)(tb_context_t *context),
+    const tb_ticker_t *ticker, tb_tick_handler_t tick_handler, const tb_context_t *initial_context,
+    const char *print_prefix);
+void tb_batch_free(tb_batch_t *batch);
+void tb_batch_set_next_tick(void *arg, bs_time_t time);
+void tb_batch_dispatch(tb_batch_t *batch, bs_time_t time);
+void *tb_mailbox_reserve(tb_mailbox_t *mailbox, const char *print_prefix, const char *file, unsigned int line);
+void tb_mailbox_commit(tb_mailbox_t *mailbox, const char *print_prefix, const char *file, unsigned int line);
+void *tb_mailbox_next(tb_mailbox_t *mailbox, const char *print_prefix, const char *file, unsigned int line);
+void tb_mailbox_release(tb_mailbox_t *mailbox, const char *print_prefix, const char *file, unsigned int line);
+void tb_sem_take(tb_context_t *context, tb_sem_t *sem, const char *print_prefix, const char *file, unsigned int line);
+void tb_sem_give(tb_sem_t *sem);
+void tb_event_wait(tb_context_t *context, tb_event_t *event, const char *print_prefix, const char *file,
+    unsigned int line);
+void tb_event_set(tb_event_t *event);
+void tb_barrier_wait(tb_context_t *context, tb_barrier_t *barrier, const char *print_prefix, const char *file,
+    unsigned int line);
+void tb_watch_wait(tb_context_t *context, tb_waiter_list_t *waiters, const char *print_prefix, const char *file,
+    unsigned int line);
+bool tb_watch_cond(tb_context_t *context, tb_waiter_list_t *waiters, bool cond, const char *print_prefix,
+    const char *file, unsigned int line);
+void tb_watch_changed(tb_waiter_list_t *waiters);
+void tb_rand_seed(tb_context_t *context, uint64_t seed);
+uint64_t tb_rand(tb_context_t *context);
+bs_time_t tb_rand_range(tb_context_t *context, bs_time_t min, bs_time_t max);
+bs_time_t tb_rand_jitter(tb_context_t *context, bs_time_t delay, unsigned int pct);
+void tb_restart(tb_context_t *context);
+void tb_finish_register(tb_context_t *context);
+void tb_finish_set_hook(void (*hook)(bool passed));
+void tb_finish(tb_context_t *context, bool passed, const char *print_prefix, const char *file, unsigned int line);
+unsigned int tb_seed_sweep(tb_context_t *context, uint64_t first_seed, unsigned int nbr_seeds,
+    bool (*run)(uint64_t seed), uint64_t *failing_seeds, unsigned int max_failing_seeds);
+unsigned int tb_run_table(tb_context_t *context, unsigned int nbr_rows, bool (*run)(unsigned int row),
+    uint64_t *failing_rows, unsigned int max_failing_rows);
+bool tb_parse_seed_arg(const char *arg, uint64_t *first_seed, unsigned int *nbr_seeds);
+void tb_timer_start(tb_context_t *context, tb_timer_t *timer, bs_time_t expiry);
+void tb_timer_stop(tb_context_t *context, tb_timer_t *timer);
+void tb_timers_update(tb_context_t *context);
+bool tb_cov_dump(const char *path);
+void tb_cov_clear(void);
+void tb_call_deadline_begin(tb_context_t *context, bs_time_t deadline, const char *print_prefix, const char *file,
+    unsigned int line);
+void tb_call_deadline_end(tb_context_t *context);
+void tb_call_abort(tb_context_t *context);
+#ifdef __cplusplus
+}
+#endif
+
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // Public definitions for use in test benches
 
+// TB_DEFER_SIGNALS selects how TB_SIGNAL_EVENT reaches the time tick handler. If false (default), the tick handler is
+// called synchronously for every signalled event. If true, the signal only schedules a tick at the current time, so all
+// events signalled at the same time (including from within the tick handler itself) are coalesced into a single
+// re-entry of the tick handler after the current event processing. #define it before including this header file.
+// In both modes, the test bench relies on this ordering: all other events (e.g. HW model events signalling the test
+// sequence) at a simulated time are handled before the tick of the test sequence at that time. A tick thus sees the
+// effects of all the events of its own time, and in deferred mode the signals of those events are coalesced with it.
+// The stand-in scheduler of the unit tests (test/tb_defs_unit_test_utils.c) implements this ordering.
+#ifndef TB_DEFER_SIGNALS
+#define TB_DEFER_SIGNALS false
+#endif
+
+// TB_CHECKPOINT_BUF_RECORD selects record mode for TB_CHECKPOINT_BUF: instead of checking the buffers against the
+// TB_CHECKPOINT_BUF_SEQ, their time/hash pairs are printed in TB_CHECKPOINT_BUF_SEQ syntax together with hex dumps of
+// their contents, so that the sequence can be created from a known good run, and byte-level differences can be found
+// by diffing the output of two runs. #define it to true before including this header file.
+#ifndef TB_CHECKPOINT_BUF_RECORD
+#define TB_CHECKPOINT_BUF_RECORD false
+#endif
+
+// TB_DEFER_CHECKPOINTS selects when TB_CHECKPOINT is verified. If false (default), each TB_CHECKPOINT is checked against
+// the TB_CHECKPOINT_SEQ immediately. If true, TB_CHECKPOINT only logs the time and value, and the logged checkpoints
+// are verified together when the log is full (TB_CHECKPOINT_LOG_SIZE entries), at TB_END (and at TB_RETURN of the top
+// level test sequence), at TB_FINISH, and at TB_CHECKPOINT_FLUSH, which keeps checkpoints logged in tight loops cheap.
+// A mismatch is reported with the same message and line as in immediate mode, only later. #define it the same before
+// including this header file in all files of the test bench.
+#ifndef TB_DEFER_CHECKPOINTS
+#define TB_DEFER_CHECKPOINTS false
+#endif
+
+// TB_RUN_SUMMARY makes TB_END (and TB_RETURN) of the top level test sequence print a one-line, machine-readable summary
+// of the run, to compare the throughput of test benches between releases (see TB_PRINT_RUN_SUMMARY). The counters are
+// always collected, at the cost of a few increments per tick handler entry. #define it to true before including this
+// header file.
+#ifndef TB_RUN_SUMMARY
+#define TB_RUN_SUMMARY false
+#endif
+
+// TB_COVERAGE enables recording of which macro expansion points of the test sequences are reached: TB_BEGIN, the
+// resumption after each wait, the entry of each TB_IF/ELSIF/ELSE branch and loop body, the exit of each block, and the
+// return from each TB_CALL. Each expansion registers its file and line at link time (see tb_cov_point_t), so several
+// points on one line are told apart, points in included headers are recorded against the header, and points never
+// reached are known too. Reaching a point is a single store. All points are written to the file named by the
+// TB_COVERAGE_FILE environment variable (default "tb_coverage.cov") at exit, or explicitly by tb_cov_dump(). The
+// tb_cov_merge tool (built by "make compile") merges the files of several runs and reports the expansion points never
+// reached and the runs adding no coverage. #define it to true before including this header file (in all test bench
+// files), e.g. with -DTB_COVERAGE=true.
+#ifndef TB_COVERAGE
+#define TB_COVERAGE false
+#endif
+
+#if TB_COVERAGE
+#define TB_COV_POINT \
+        { \
+            static tb_cov_point_t tb_cov_point __attribute__ ((__section__ ("tb_cov_points"), __used__)) = \
+                { __FILE__, __LINE__, false }; \
+            tb_cov_point.is_reached = true; \
+        }
+#else
+#define TB_COV_POINT
+#endif
+
 // TB_GLOBALS defines needed globals. Must be instantiated once per test bench at file level. Is not necessary in a
 // file containing only sub-test functions and no time tick handler.
 #define TB_GLOBALS \
-    static tb_context_t tb_context = { \
+    static tb_context_t tb_context = TB_CONTEXT_INITIALIZER; \
+    static tb_context_t *tb_context_ptr = &tb_context;
+
+// TB_GLOBALS_W_MAILBOX is TB_GLOBALS with the TB_MAILBOX of the test bench defined along with the context, instead of
+// by TB_MAILBOX in the time tick handler. The mailbox is then bound at static initialization, so event handlers can
+// send messages before the test sequence has been entered for the first time.
+// Example: TB_GLOBALS_W_MAILBOX(packet_t, 8)
+#define TB_GLOBALS_W_MAILBOX(_msg_type, _capacity) \
+    TB_MAILBOX_DEFINE(tb_global_mailbox, _msg_type, _capacity) \
+    static tb_context_t tb_context = TB_CONTEXT_INITIALIZER_W_MAILBOX(&tb_global_mailbox); \
+    static tb_context_t *tb_context_ptr = &tb_context;
+
+// TB_CONTEXT_INITIALIZER is the initial value of a test bench context.
+#define TB_CONTEXT_INITIALIZER \
+    TB_CONTEXT_INITIALIZER_W_MAILBOX(NULL)
+
+// TB_CONTEXT_INITIALIZER_W_MAILBOX is the initial value of a test bench context bound to the specified mailbox (see
+// TB_MAILBOX_DEFINE).
+#define TB_CONTEXT_INITIALIZER_W_MAILBOX(_mailbox) \
+    { \
         .is_waiting_for_cond = false, \
         .non_time_event_occurred = false, \
         .waiting_deadline = TIME_NEVER, \
+        .poll_period = 0, \
+        .poll_max_period = 0, \
         .is_func_done = false, \
         .checkpoints = NULL, \
         .nbr_checkpoints = 0, \
-        .checkpoint_idx = 0 \
-    }; \
-    static tb_context_t *tb_context_ptr = &tb_context;
+        .checkpoint_idx = 0, \
+        .checkpoint_log = NULL, \
+        .defer_checkpoints = TB_DEFER_CHECKPOINTS, \
+        .buf_checkpoints = NULL, \
+        .nbr_buf_checkpoints = 0, \
+        .buf_checkpoint_idx = 0, \
+        .record_buf_checkpoints = TB_CHECKPOINT_BUF_RECORD, \
+        .mailbox = (_mailbox), \
+        .defer_signals = TB_DEFER_SIGNALS, \
+        .next_tick_time = TIME_NEVER, \
+        .nbr_signals = 0, \
+        .nbr_signal_entries = 0, \
+        .is_started = false, \
+        .nbr_entries = 0, \
+        .nbr_loop_ticks = 0, \
+        .nbr_ticker_programs = 0, \
+        .start_time = 0, \
+        .start_wall_ns = 0, \
+        .tick_handler = NULL, \
+        .ticker = NULL, \
+        .next_waiter = NULL, \
+        .is_sync_granted = false, \
+        .rand_state = { 0 }, \
+        .run_id = 0, \
+        .call_depth = 0, \
+        .call_epoch = 0, \
+        .call_run_ids = { 0 }, \
+        .call_deadlines = { 0 }, \
+        .call_deadline_mask = 0, \
+        .call_deadline = TIME_NEVER, \
+        .is_call_timed_out = false, \
+        .sync_waiters = NULL, \
+        .sync_nbr_arrived = NULL, \
+        .timer_wheel = NULL, \
+        .resume_points = NULL, \
+        .resume_stride = 0, \
+        .instance = 0, \
+        .finish_status = TB_FINISH_PENDING, \
+        .is_finish_registered = false, \
+        .next_finish_context = NULL \
+    }
 
 // TB_PRINT_PREFIX defines a string to be prepended to all printed messages. Optionally #undef this in the test bench
 // and #define it to some meaningful string. Or #define it before including this header file.
@@ -128,8 +560,8 @@ typedef struct
 // TB_ASSERT checks that the specified condition is true, and if not, prints the specified printf-style formatted error
 // message, and terminates the test with status failed.
 #define TB_ASSERT(_cond, _fmt_str, ...) \
-        if (!(_cond)) bs_trace_print(BS_TRACE_ERROR, __FILE__, __LINE__, 0, BS_TRACE_TIME_PROVIDED, \
-            tm_get_hw_time(), TB_PRINT_PREFIX "TB_ASSERT failed: " _fmt_str "\n", ##__VA_ARGS__);
+        if (!(_cond)) tb_assert_failed(__FILE__, __LINE__, TB_PRINT_PREFIX "TB_ASSERT failed: " _fmt_str "\n", \
+            ##__VA_ARGS__);
 
 // TB_CHECKPOINT_SEQ defines a list of time/value pairs to be used later by TB_CHECKPOINT statements.
 // Must be put inside the time tick handler before TB_BEGIN, if checkpoints are used. Should normally NOT be used in
@@ -140,48 +572,235 @@ typedef struct
     tb_context_ptr->checkpoints = tb_checkpoints; \
     tb_context_ptr->nbr_checkpoints = sizeof(tb_checkpoints)/sizeof(tb_checkpoints[0]);
 
+// TB_CHECKPOINT_BUF_SEQ defines a list of time/hash pairs to be used later by TB_CHECKPOINT_BUF statements, like
+// TB_CHECKPOINT_SEQ does for TB_CHECKPOINT. The hash is the XXH64 (seed 0) of the expected buffer contents, as printed
+// in record mode (see TB_CHECKPOINT_BUF_RECORD) or by e.g. "xxhsum -H64".
+// Example: TB_CHECKPOINT_BUF_SEQ({1e6, 0x44bc2cf5ad770999}, {2e6, 0xef46db3751d8e999})
+#define TB_CHECKPOINT_BUF_SEQ(...) \
+    static const tb_buf_checkpoint_t tb_buf_checkpoints[] = {__VA_ARGS__}; \
+    tb_context_ptr->buf_checkpoints = tb_buf_checkpoints; \
+    tb_context_ptr->nbr_buf_checkpoints = sizeof(tb_buf_checkpoints)/sizeof(tb_buf_checkpoints[0]);
+
+// TB_TICK_HANDLER specifies the time tick handler of the test bench, so that other test bench contexts and event
+// handlers can wake it up via the synchronization objects (TB_SEM/TB_EVENT/TB_BARRIER).
+// Must be put inside the time tick handler before TB_BEGIN, if the test sequence waits for synchronization objects.
+// Example: TB_TICK_HANDLER(test_tick)
+#define TB_TICK_HANDLER(_tick_handler) \
+    tb_context_ptr->tick_handler = (_tick_handler);
+
+// TB_TICKER specifies a pointer to a tb_ticker_t through which time ticks are scheduled, instead of the device's
+// BabbleSim ticker. Must be put inside the time tick handler before TB_BEGIN, if used.
+#define TB_TICKER(_ticker_ptr) \
+    tb_context_ptr->ticker = (_ticker_ptr);
+
+// A tick multiplexer lets several tick handlers (e.g. a main test sequence and a background monitor sequence, each with
+// its own test bench context) share the device's ticker, as if each had its own. Each tick handler is added with a
+// virtual ticker, which its context uses via TB_TICKER, and the device's tick handler dispatches the ticks with
+// TB_TICK_MUX_DISPATCH. Only the tick handlers whose ticks are due are called. Define the multiplexer and virtual
+// tickers as global variables; the initializer specifies the device ticker (NULL for the device's BabbleSim ticker).
+// Example: tb_tick_mux_t mux = TB_TICK_MUX_INIT(NULL); tb_mux_ticker_t monitor_ticker;
+//          void device_tick(bs_time_t time) { TB_TICK_MUX_DISPATCH(mux); }
+//          In the initialization: TB_TICK_MUX_ADD(mux, monitor_ticker, monitor_tick);
+//          In monitor_tick before TB_BEGIN: TB_TICKER(&monitor_ticker.ticker);
+#define TB_TICK_MUX_INIT(_ticker_ptr) \
+    { .ticker = (_ticker_ptr), .heap = { NULL }, .nbr_tickers = 0, .programmed_time = TIME_NEVER, \
+      .is_dispatching = false }
+
+// TB_TICK_MUX_ADD adds the specified tick handler with the specified virtual ticker to the multiplexer. Its first tick
+// is at the current time, so that its test sequence starts like with a device ticker set to the start time.
+#define TB_TICK_MUX_ADD(_mux, _mux_ticker, _tick_handler) \
+    tb_tick_mux_add(&(_mux), &(_mux_ticker), _tick_handler);
+
+// TB_TICK_MUX_DISPATCH calls the tick handlers of the multiplexer whose ticks are due. To be called by the device's
+// tick handler.
+#define TB_TICK_MUX_DISPATCH(_mux) \
+    tb_tick_mux_dispatch(&(_mux), tm_get_hw_time());
+
+// A batch runs N instances of one test sequence, e.g. the same sequence on hundreds of simulated devices, from one
+// device tick handler. The sequence is written as a sub-test function (with TB_CONTEXT_PARAM), which is shared by the
+// instances; each instance has its own context and resume points, so it advances independently. The instances due at
+// a tick are stepped one at a time, ordered by resume point, so that consecutive instances run the same code. There is
+// no lock-step execution: each instance is a full tb_context_t, and its wait conditions are evaluated by its own step,
+// not in a loop over the instances. The instances use deferred signals (see TB_DEFER_SIGNALS). State kept in static variables (including TB_LOCALs and
+// TB_FOR loop variables) is shared by the instances, so keep per-instance state in arrays indexed by TB_INSTANCE.
+// Example: static tb_batch_t batch; static int nbr_rx[NBR_DEVICES];
+//          void device_tick(bs_time_t time) { TB_BATCH_DISPATCH(batch); }
+//          void device_seq(TB_CONTEXT_PARAM) { TB_BEGIN TB_WAIT_COND(nbr_rx[TB_INSTANCE] > 0); ... TB_END }
+//          In the initialization: TB_BATCH_INIT(batch, NBR_DEVICES, device_seq, NULL, device_tick);
+//          In the rx event handler of device i: nbr_rx[i]++; TB_BATCH_SIGNAL_EVENT(batch, i);
+
+// TB_BATCH_INIT initializes the specified batch with the specified number of instances of the specified test sequence,
+// using the specified device ticker (NULL for the device's BabbleSim ticker) and device tick handler (which calls
+// TB_BATCH_DISPATCH). The first tick of the instances is at the current time.
+#define TB_BATCH_INIT(_batch, _nbr_instances, _func, _ticker_ptr, _tick_handler) \
+    { \
+        static const tb_context_t tb_batch_initial_context = TB_CONTEXT_INITIALIZER; \
+        tb_batch_init(&(_batch), _nbr_instances, _func, _ticker_ptr, _tick_handler, &tb_batch_initial_context, \
+            TB_PRINT_PREFIX); \
+    }
+
+// TB_BATCH_FREE frees the instances of the specified batch.
+#define TB_BATCH_FREE(_batch) \
+    tb_batch_free(&(_batch));
+
+// TB_BATCH_DISPATCH steps the instances of the batch whose ticks are due. To be called by the device's tick handler.
+#define TB_BATCH_DISPATCH(_batch) \
+    tb_batch_dispatch(&(_batch), tm_get_hw_time());
+
+// TB_BATCH_SIGNAL_EVENT signals to the specified instance of the batch that a non-time-tick event has occurred, like
+// TB_SIGNAL_EVENT.
+#define TB_BATCH_SIGNAL_EVENT(_batch, _instance) \
+    tb_signal_event(&(_batch).contexts[_instance], (_batch).contexts[_instance].tick_handler);
+
+// TB_BATCH_CONTEXT evaluates to (a pointer to) the context of the specified instance of the batch.
+#define TB_BATCH_CONTEXT(_batch, _instance) \
+    (&(_batch).contexts[_instance])
+
+// TB_INSTANCE evaluates to the index of the batch instance running the (sub-)test sequence (0 if not in a batch).
+#define TB_INSTANCE \
+    (tb_context_ptr->instance)
+
 // TB_CHECKPOINT checks that the current time and specified value match the current checkpoint item in the
 // TB_CHECKPOINT_SEQ.
 // Example: Given the TB_CHECKPOINT_SEQ example above, TB_CHECKPOINT should be called 3 times at times 0, 1e6, and 2e6
 // with parameters 1, 2, and 3 respectively. Otherwise the test will fail.
 #define TB_CHECKPOINT(_val) \
+        if (TB_DEFER_CHECKPOINTS) \
         { \
-            char tb_strbuf[20]; \
-            TB_ASSERT(tb_context_ptr->checkpoints != NULL, "TB_CHECKPOINT without TB_CHECKPOINT_SEQ!"); \
-            TB_ASSERT(tb_context_ptr->checkpoint_idx < tb_context_ptr->nbr_checkpoints, \
-                "More TB_CHECKPOINTs than items in TB_CHECKPOINT_SEQ!"); \
-            const tb_checkpoint_t *chkpnt_ptr = &tb_context_ptr->checkpoints[tb_context_ptr->checkpoint_idx]; \
-            TB_ASSERT(chkpnt_ptr->time == tm_get_hw_time() && chkpnt_ptr->val == (_val), \
-                "TB_CHECKPOINT != TB_CHECKPOINT_SEQ[%d]: actual value=%d, expected value=%d, expected time=%s", \
-                tb_context_ptr->checkpoint_idx, (_val), chkpnt_ptr->val, \
-                bs_time_to_str(tb_strbuf, chkpnt_ptr->time)); \
-            tb_context_ptr->checkpoint_idx++; \
+            tb_checkpoint_log_t *tb_chkpnt_log = tb_context_ptr->checkpoint_log; \
+            if (tb_chkpnt_log && tb_chkpnt_log->nbr < TB_CHECKPOINT_LOG_SIZE) \
+            { \
+                tb_chkpnt_log->times[tb_chkpnt_log->nbr] = tm_get_hw_time(); \
+                tb_chkpnt_log->vals[tb_chkpnt_log->nbr] = (_val); \
+                tb_chkpnt_log->files[tb_chkpnt_log->nbr] = __FILE__; \
+                tb_chkpnt_log->lines[tb_chkpnt_log->nbr++] = __LINE__; \
+            } \
+            else \
+                tb_checkpoint_log_full(tb_context_ptr, _val, TB_PRINT_PREFIX, __FILE__, __LINE__); \
+        } \
+        else \
+        { \
+            int tb_chkpnt_val = (_val); \
+            int tb_chkpnt_idx = tb_context_ptr->checkpoint_idx; \
+            if (tb_chkpnt_idx < tb_context_ptr->nbr_checkpoints && \
+                tb_context_ptr->checkpoints[tb_chkpnt_idx].time == tm_get_hw_time() && \
+                tb_context_ptr->checkpoints[tb_chkpnt_idx].val == tb_chkpnt_val) \
+                tb_context_ptr->checkpoint_idx = tb_chkpnt_idx + 1; \
+            else \
+                tb_checkpoint_failed(tb_context_ptr, tb_chkpnt_val, TB_PRINT_PREFIX, __FILE__, __LINE__); \
         }
 
+// TB_CHECKPOINT_FLUSH verifies the checkpoints logged but not verified yet (see TB_DEFER_CHECKPOINTS), e.g. before
+// checking that the checkpoint sequence was completed.
+#define TB_CHECKPOINT_FLUSH() \
+    tb_checkpoints_verify(tb_context_ptr, TB_PRINT_PREFIX);
+
+// TB_CHECKPOINT_BUF checks that the current time and the hash of the specified buffer contents match the current
+// checkpoint item in the TB_CHECKPOINT_BUF_SEQ. Only the hash is compared, so large buffers can be checked at many
+// checkpoints without storing the expected contents.
+// Example: Given the TB_CHECKPOINT_BUF_SEQ example above, TB_CHECKPOINT_BUF("abc", 3) at time 1e6 and
+// TB_CHECKPOINT_BUF(NULL, 0) at time 2e6 pass.
+#define TB_CHECKPOINT_BUF(_ptr, _len) \
+        tb_checkpoint_buf(tb_context_ptr, _ptr, _len, TB_PRINT_PREFIX, __FILE__, __LINE__);
+
 // TB_SIGNAL_EVENT signals to the time tick handler that a non-time-tick event has occurred. Event handlers should use
-// this macro.
+// this macro. See TB_DEFER_SIGNALS.
 #define TB_SIGNAL_EVENT(_tick_handler) \
+    tb_signal_event(tb_context_ptr, _tick_handler);
+
+// TB_SIGNAL_COALESCING_RATIO is the number of TB_SIGNAL_EVENTs per tick handler entry caused by them (always 1 unless
+// TB_DEFER_SIGNALS is true).
+#define TB_SIGNAL_COALESCING_RATIO \
+    tb_signal_coalescing_ratio(tb_context_ptr)
+
+// TB_PRINT_RUN_SUMMARY prints a one-line summary of the run so far: the tick handler entries (total, time ticks, and
+// caused by signalled events), the signalled events, the ticks at the end of loop iterations, the ticker programmings,
+// the simulated and wall-clock time since the first entry and their ratio, and the peak RSS of the process. Printed at
+// the end of the top level test sequence if TB_RUN_SUMMARY is true.
+#define TB_PRINT_RUN_SUMMARY() \
+    tb_run_summary(tb_context_ptr, TB_PRINT_PREFIX);
+
+// TB_MAILBOX_DEFINE defines a static mailbox with the specified name, of messages of the specified type.
+#define TB_MAILBOX_DEFINE(_name, _msg_type, _capacity) \
+    typedef char tb_mailbox_capacity_must_be_power_of_two[((_capacity) & ((_capacity) - 1)) == 0 ? 1 : -1] \
+        __attribute__ ((__unused__)); \
+    static _msg_type _name##_slots[_capacity]; \
+    static tb_mailbox_t _name = { \
+        .slots = (unsigned char *)_name##_slots, \
+        .slot_size = sizeof(_msg_type), \
+        .capacity = (_capacity), \
+        .head = 0, \
+        .tail = 0, \
+        .is_slot_reserved = false, \
+        .is_msg_held = false \
+    };
+
+// TB_MAILBOX defines a mailbox of messages of the specified type, through which event handlers can pass data to the
+// test sequence without overwriting data not yet consumed. The capacity (number of messages) must be a power of two.
+// Must be put inside the time tick handler before TB_BEGIN, if messages are used. Sub-test functions inherit the
+// calling function's TB_MAILBOX. The mailbox is bound to the context when the tick handler is first entered; event
+// handlers that may send messages before that must use TB_GLOBALS_W_MAILBOX instead.
+// Example: TB_MAILBOX(packet_t, 8)
+#define TB_MAILBOX(_msg_type, _capacity) \
+    TB_MAILBOX_DEFINE(tb_mailbox, _msg_type, _capacity) \
+    tb_context_ptr->mailbox = &tb_mailbox;
+
+// TB_MSG_RESERVE reserves the next free message slot in the TB_MAILBOX and evaluates to a pointer to it, so that an
+// event handler can fill in the message in place. The test fails if the mailbox is full.
+// Example: packet_t *pkt = TB_MSG_RESERVE(); pkt->len = len; TB_MSG_SEND(test_tick);
+#define TB_MSG_RESERVE() \
+    tb_mailbox_reserve(tb_context_ptr->mailbox, TB_PRINT_PREFIX, __FILE__, __LINE__)
+
+// TB_MSG_SEND hands the message reserved by TB_MSG_RESERVE over to the test sequence, and signals the event to the
+// time tick handler like TB_SIGNAL_EVENT.
+#define TB_MSG_SEND(_tick_handler) \
     { \
-        tb_context_ptr->non_time_event_occurred = true; \
-        (_tick_handler)(tm_get_hw_time()); \
-    } \
+        tb_mailbox_commit(tb_context_ptr->mailbox, TB_PRINT_PREFIX, __FILE__, __LINE__); \
+        tb_signal_event(tb_context_ptr, _tick_handler); \
+    }
+
+// TB_CALL_RUN_ID evaluates to the run id of the sequences at the current call depth of the context.
+#define TB_CALL_RUN_ID(_context) \
+    ((_context)->call_run_ids[(_context)->call_depth < TB_MAX_CALL_DEPTH ? (_context)->call_depth : \
+        TB_MAX_CALL_DEPTH - 1])
 
 // TB_BEGIN starts the (sub-)test sequence. Should be the first statement in the tick handler or sub-test function
 // (except for TB_CHECKPOINT_SEQ if used).
 #define TB_BEGIN \
+    if (tb_context_ptr->call_depth == 0) \
+    { \
+        if (!tb_context_ptr->is_started) \
+        { \
+            tb_context_ptr->is_started = true; \
+            tb_run_summary_start(tb_context_ptr); \
+        } \
+        tb_context_ptr->nbr_entries++; \
+    } \
     tb_context_ptr->is_func_done = false; \
     if (tb_context_ptr->non_time_event_occurred) \
     { \
-        tb_context_ptr->non_time_event_occurred = false; \
-        if (!tb_context_ptr->is_waiting_for_cond) \
+        if (!tb_resume_on_event(tb_context_ptr)) \
             return; \
     } \
+    else if (tb_context_ptr->next_tick_time <= tm_get_hw_time()) \
+        tb_context_ptr->next_tick_time = TIME_NEVER; \
+    if (tb_context_ptr->timer_wheel) \
+        tb_timers_update(tb_context_ptr); \
     tb_blk_info_t tb_blk_info[TB_MAX_BLK_LEVELS] __attribute__ ((__unused__)); \
     int tb_cur_blk_level = 0; \
     int tb_next_blk_level __attribute__ ((__unused__)) = 0; \
-    static int tb_next_line = 0; \
-    if (tb_next_line == 0) \
-    {
+    static tb_resume_point_t tb_func_resume_point = { 0, 0 }; \
+    tb_resume_point_t *const tb_resume_point = tb_context_ptr->resume_points ? \
+        &tb_context_ptr->resume_points[tb_context_ptr->call_depth * tb_context_ptr->resume_stride] : \
+        &tb_func_resume_point; \
+    if (tb_resume_point->run_id != TB_CALL_RUN_ID(tb_context_ptr)) \
+    { \
+        tb_resume_point->run_id = TB_CALL_RUN_ID(tb_context_ptr); \
+        tb_resume_point->line = 0; \
+    } \
+    if (tb_resume_point->line == 0) \
+    { \
+        TB_COV_POINT
 
 // TB_TEST_STEP prints the test step title (as well as the time and line number). Can be used any number of times in
 // a test.
@@ -190,175 +809,415 @@ typedef struct
 
 // TB_WAIT_UNTIL waits until the specified absolute time point.
 #define TB_WAIT_UNTIL(_time) \
-        { \
-            char tb_strbuf[20]; \
-            TB_ASSERT(_time >= tm_get_hw_time(), "TB_WAIT_UNTIL time %s is in the past!", \
-                bs_time_to_str(tb_strbuf, (_time))); \
-        } \
-        bst_ticker_set_next_tick_absolute(_time); \
-        tb_next_line = __LINE__; \
+        if ((_time) < tm_get_hw_time()) \
+            tb_wait_until_in_past(_time, TB_PRINT_PREFIX, __FILE__, __LINE__); \
+        tb_set_next_tick(tb_context_ptr, _time); \
+        tb_resume_point->line = __LINE__; \
         return; \
     } \
-    if (tb_next_line == __LINE__) \
-    {
+    if (tb_resume_point->line == __LINE__) \
+    { \
+        TB_COV_POINT
 
 // TB_WAIT waits for the specified delay to elapse.
 #define TB_WAIT(_delay) \
-        bst_ticker_set_next_tick_delta(_delay); \
-        tb_next_line = __LINE__; \
+        tb_set_next_tick(tb_context_ptr, (_delay) + tm_get_hw_time()); \
+        tb_resume_point->line = __LINE__; \
         return; \
     } \
-    if (tb_next_line == __LINE__) \
-    {
+    if (tb_resume_point->line == __LINE__) \
+    { \
+        TB_COV_POINT
+
+// TB_RAND evaluates to a pseudo-random integer in the range [_min, _max], drawn from the context's fast pseudo-random
+// generator. The generator is seeded by TB_RAND_SEED (seed 0 if not seeded), so runs are reproducible per seed.
+#define TB_RAND(_min, _max) \
+    tb_rand_range(tb_context_ptr, _min, _max)
+
+// TB_RAND_SEED seeds the context's pseudo-random generator, e.g. with a seed given on the command line. The function
+// tb_parse_seed_arg() parses command line arguments of the form -tb_seed=<seed> or -tb_seeds=<first seed>:<number of
+// seeds> (the latter for TB_SEED_SWEEP).
+#define TB_RAND_SEED(_seed) \
+    tb_rand_seed(tb_context_ptr, _seed);
+
+// TB_WAIT_RAND waits for a pseudo-random delay in the range [_min, _max] (see TB_RAND).
+#define TB_WAIT_RAND(_min, _max) \
+        TB_WAIT(tb_rand_range(tb_context_ptr, _min, _max))
+
+// TB_WAIT_JITTER waits for the specified delay with a pseudo-random jitter of up to +/- the specified (integer)
+// percentage of the delay (see TB_RAND).
+// Example: TB_WAIT_JITTER(1e3, 10) waits for between 900 and 1100 us.
+#define TB_WAIT_JITTER(_delay, _pct) \
+        TB_WAIT(tb_rand_jitter(tb_context_ptr, _delay, _pct))
+
+// TB_SEED_SWEEP runs the test once per seed in the range [_first_seed, _first_seed + _nbr_seeds), back-to-back in the
+// same process, and records the seeds for which the test failed. Before each run, the test bench context is restarted
+// (see TB_RESET) and its pseudo-random generator is seeded with the seed. The specified run
+// function must (re)initialize the simulation state, run the simulation, and return true if the test passed. A failing
+// TB_ASSERT or TB_CHECKPOINT ends the run immediately instead of terminating the process. Up to _max_failing_seeds
+// failing seeds are stored in the _failing_seeds array. Evaluates to the number of failing seeds.
+// Example: nbr_failing = TB_SEED_SWEEP(0, 10000, run_test, failing_seeds, 100);
+#define TB_SEED_SWEEP(_first_seed, _nbr_seeds, _run_func, _failing_seeds, _max_failing_seeds) \
+    tb_seed_sweep(tb_context_ptr, _first_seed, _nbr_seeds, _run_func, _failing_seeds, _max_failing_seeds)
+
+// TB_RESET restores all state managed by tb_defs.h of the specified test bench context, e.g. tb_context_ptr, to what it
+// was before the test started: the sequence and all sub-test sequences start over from TB_BEGIN, TB_LOCALs are
+// re-initialized, and checkpoints, waits, messages, and the pseudo-random generator are reset. All timers started by
+// the context are stopped, including those that have expired, so TB_TIMER_EXPIRED is false for them until restarted.
+// The simulation state (time, pending ticks and events) and other test bench variables are not reset.
+#define TB_RESET(_context_ptr) \
+    tb_restart(_context_ptr);
+
+// TB_FINISH marks the test bench context as finished, with the test passed if the specified condition is true, so that
+// the simulation can end before its configured end time. The run ends as soon as all test bench contexts of the process
+// registered with TB_FINISH_REGISTER are finished (a context finishing without being registered is registered then).
+// The hook set with TB_FINISH_HOOK is then called, with whether all of them passed; without a hook, the process exits,
+// with an error if any failed. The sequence itself continues after TB_FINISH, so put it just before TB_END.
+// Example: In the initialization of each device: TB_FINISH_REGISTER(tb_context_ptr);
+//          At the end of each test sequence: TB_FINISH(nbr_errors == 0); TB_END
+#define TB_FINISH(_passed) \
+        tb_finish(tb_context_ptr, _passed, TB_PRINT_PREFIX, __FILE__, __LINE__);
+
+// TB_FINISH_REGISTER registers the specified test bench context, e.g. tb_context_ptr, so that the run does not end
+// before it is finished (see TB_FINISH). Register all contexts at initialization, before any can finish.
+#define TB_FINISH_REGISTER(_context_ptr) \
+    tb_finish_register(_context_ptr);
+
+// TB_FINISH_HOOK sets the function (void hook(bool passed)) called when all registered test bench contexts are
+// finished, e.g. to end the simulation in a way specific to the device.
+#define TB_FINISH_HOOK(_hook) \
+    tb_finish_set_hook(_hook);
+
+// TB_LOCAL defines a static variable of the specified type, which is (re)initialized to the specified value at the
+// first entry of the function after the test started or was reset by TB_RESET (or restarted by TB_SEED_SWEEP or
+// TB_RUN_TABLE). Must be put inside the time tick handler or sub-test function before TB_BEGIN.
+// Example: TB_LOCAL(int, nbr_retries, 0)
+#define TB_LOCAL(_type, _name, _init_val) \
+    static _type _name; \
+    static unsigned int _name##_tb_run_id = ~0u; \
+    if (_name##_tb_run_id != tb_context_ptr->run_id) \
+    { \
+        _name##_tb_run_id = tb_context_ptr->run_id; \
+        _name = (_init_val); \
+    }
+
+// TB_RUN_TABLE runs the test once per row of the specified parameter table (array), back-to-back in the same process,
+// and records the rows for which the test failed. Before each run, the test bench context is reset like TB_RESET.
+// The specified run function gets the row index, and must (re)initialize the simulation state, run the simulation,
+// and return true if the test passed. Failures are handled like in TB_SEED_SWEEP. Up to _max_failing_rows failing row
+// indexes are stored in the _failing_rows (uint64_t) array. Evaluates to the number of failing rows.
+// Example: nbr_failing = TB_RUN_TABLE(scenarios, run_scenario, failing_rows, 100);
+#define TB_RUN_TABLE(_rows, _run_func, _failing_rows, _max_failing_rows) \
+    tb_run_table(tb_context_ptr, sizeof(_rows) / sizeof((_rows)[0]), _run_func, _failing_rows, _max_failing_rows)
 
 // TB_WAIT_COND waits for the specified condition to occur.
 #define TB_WAIT_COND(_cond) \
         tb_context_ptr->is_waiting_for_cond = true; \
-        tb_next_line = __LINE__; \
+        if (tb_context_ptr->timer_wheel || tb_context_ptr->call_deadline_mask) \
+            tb_timers_update(tb_context_ptr); \
+        tb_resume_point->line = __LINE__; \
     } \
-    if (tb_next_line == __LINE__) \
+    if (tb_resume_point->line == __LINE__) \
     { \
         if (!(_cond)) \
             return; \
-        tb_context_ptr->is_waiting_for_cond = false;
+        tb_context_ptr->is_waiting_for_cond = false; \
+        if (tb_context_ptr->timer_wheel) \
+            tb_timers_update(tb_context_ptr); \
+        TB_COV_POINT
 
 // TB_WAIT_COND_W_DEADLINE waits for the specified condition to occur, or until the specified absolute time point,
 // whichever happens first.
 #define TB_WAIT_COND_W_DEADLINE(_cond, _time) \
-        bst_ticker_set_next_tick_absolute(_time); \
-        tb_context_ptr->waiting_deadline = _time; \
-        tb_context_ptr->is_waiting_for_cond = true; \
-        tb_next_line = __LINE__; \
+        tb_wait_cond_begin(tb_context_ptr, _time); \
+        tb_resume_point->line = __LINE__; \
     } \
-    if (tb_next_line == __LINE__) \
+    if (tb_resume_point->line == __LINE__) \
     { \
         if (!(_cond) && (tm_get_hw_time() < tb_context_ptr->waiting_deadline)) \
             return; \
-        tb_context_ptr->waiting_deadline = TIME_NEVER; \
-        bst_ticker_set_next_tick_absolute(TIME_NEVER); \
-        tb_context_ptr->is_waiting_for_cond = false;
+        tb_wait_cond_end(tb_context_ptr); \
+        TB_COV_POINT
 
 // TB_WAIT_COND_W_DEADLINE_DELTA waits for the specified condition to occur, or for the specified delay to elapse,
 // whichever happens first.
 #define TB_WAIT_COND_W_DEADLINE_DELTA(_cond, _delay) \
-        bst_ticker_set_next_tick_delta(_delay); \
-        tb_context_ptr->waiting_deadline = _delay + tm_get_hw_time(); \
-        tb_context_ptr->is_waiting_for_cond = true; \
-        tb_next_line = __LINE__; \
+        tb_wait_cond_begin(tb_context_ptr, (_delay) + tm_get_hw_time()); \
+        tb_resume_point->line = __LINE__; \
     } \
-    if (tb_next_line == __LINE__) \
+    if (tb_resume_point->line == __LINE__) \
     { \
         if (!(_cond) && (tm_get_hw_time() < tb_context_ptr->waiting_deadline)) \
             return; \
-        tb_context_ptr->waiting_deadline = TIME_NEVER; \
-        bst_ticker_set_next_tick_absolute(TIME_NEVER); \
-        tb_context_ptr->is_waiting_for_cond = false;
+        tb_wait_cond_end(tb_context_ptr); \
+        TB_COV_POINT
 
 // TB_WAIT_COND_ASSERT waits for the specified condition to occur, and, if the condition doesn't occur within the
 // specified max delay, prints the specified printf-style formatted error message, and terminates the test with status
 // failed.
 #define TB_WAIT_COND_ASSERT(_cond, _max_delay, _fmt_str, ...) \
-        bst_ticker_set_next_tick_delta(_max_delay); \
-        tb_context_ptr->waiting_deadline = _max_delay + tm_get_hw_time(); \
-        tb_context_ptr->is_waiting_for_cond = true; \
-        tb_next_line = __LINE__; \
+        tb_wait_cond_begin(tb_context_ptr, (_max_delay) + tm_get_hw_time()); \
+        tb_resume_point->line = __LINE__; \
     } \
-    if (tb_next_line == __LINE__) \
+    if (tb_resume_point->line == __LINE__) \
     { \
         if (!(_cond) && (tm_get_hw_time() < tb_context_ptr->waiting_deadline)) \
             return; \
         TB_ASSERT(_cond, "TB_WAIT_COND_ASSERT failed: " _fmt_str, ## __VA_ARGS__); \
-        tb_context_ptr->waiting_deadline = TIME_NEVER; \
-        bst_ticker_set_next_tick_absolute(TIME_NEVER); \
-        tb_context_ptr->is_waiting_for_cond = false;
+        tb_wait_cond_end(tb_context_ptr); \
+        TB_COV_POINT
+
+// TB_WAIT_COND_POLL waits for the specified condition to occur, or until the specified absolute time point (TIME_NEVER
+// for none), whichever happens first, for conditions that are not (always) signalled by TB_SIGNAL_EVENT. The condition
+// is re-checked after _min_period, and then with the period doubling after each re-check up to _max_period, so a
+// condition becoming true is detected at most _max_period late, with a number of time ticks that grows only
+// logarithmically for long waits. Events signalled meanwhile (by TB_SIGNAL_EVENT) also re-check the condition, without
+// affecting the schedule.
+// Example: TB_WAIT_COND_POLL(model_reg_read(STATUS) & READY, 1, 1e3, TIME_NEVER)
+#define TB_WAIT_COND_POLL(_cond, _min_period, _max_period, _time) \
+        tb_wait_cond_poll_begin(tb_context_ptr, _min_period, _max_period, _time); \
+        tb_resume_point->line = __LINE__; \
+    } \
+    if (tb_resume_point->line == __LINE__) \
+    { \
+        if (!(_cond) && (tm_get_hw_time() < tb_context_ptr->waiting_deadline)) \
+        { \
+            tb_wait_cond_poll(tb_context_ptr); \
+            return; \
+        } \
+        tb_wait_cond_end(tb_context_ptr); \
+        TB_COV_POINT
+
+// Timers let a test sequence keep several timeouts running at the same time (e.g. a retransmission timer, a supervision
+// timeout, and an overall test deadline), and wait for any combination of them and other conditions. A timer belongs
+// to the context that started it. Define timers as global variables with the initializer below.
+// Example: tb_timer_t retx_timer = TB_TIMER_INIT;
+#define TB_TIMER_INIT \
+    { .expiry = TIME_NEVER, .prev = NULL, .next = NULL, .level = 0, .slot = 0, .is_in_wheel = false, .wheel = NULL, \
+      .next_owned = NULL }
+
+// TB_TIMER_START (re)starts the specified timer to expire after the specified delay. Can also be used outside test
+// sequences, e.g. in event handlers.
+#define TB_TIMER_START(_timer, _delay) \
+        tb_timer_start(tb_context_ptr, &(_timer), (_delay) + tm_get_hw_time());
+
+// TB_TIMER_STOP stops the specified timer. A stopped timer never expires.
+#define TB_TIMER_STOP(_timer) \
+        tb_timer_stop(tb_context_ptr, &(_timer));
+
+// TB_TIMER_EXPIRED evaluates to true if the specified timer has expired (and has not been restarted or stopped since).
+// Can be combined with other conditions in TB_WAIT_COND and its variants.
+// Example: TB_WAIT_COND(ack_received || TB_TIMER_EXPIRED(retx_timer))
+#define TB_TIMER_EXPIRED(_timer) \
+    ((_timer).expiry <= tm_get_hw_time())
+
+// TB_WAIT_TIMER waits for the specified timer to expire. Waits forever if the timer is stopped.
+#define TB_WAIT_TIMER(_timer) \
+        TB_WAIT_COND(TB_TIMER_EXPIRED(_timer))
+
+// TB_MSG_NEXT releases the message held by the test sequence (if any), sets the specified pointer to the oldest
+// message in the TB_MAILBOX (or NULL if the mailbox is empty), and evaluates to true if there was a message. The
+// message is read in place and stays valid until it is released by the next TB_MSG_NEXT, TB_WAIT_MSG, or
+// TB_MSG_RELEASE. As it does not wait, it can be used in a plain C loop to handle a burst of messages at once.
+// Example: while (TB_MSG_NEXT(pkt)) handle_packet(pkt);
+#define TB_MSG_NEXT(_ptr) \
+    (((_ptr) = tb_mailbox_next(tb_context_ptr->mailbox, TB_PRINT_PREFIX, __FILE__, __LINE__)) != NULL)
+
+// TB_MSG_RELEASE releases the message held by the test sequence, making its slot available to event handlers.
+#define TB_MSG_RELEASE \
+    tb_mailbox_release(tb_context_ptr->mailbox, TB_PRINT_PREFIX, __FILE__, __LINE__);
+
+// TB_WAIT_MSG waits for a message to be available in the TB_MAILBOX, and sets the specified pointer to it like
+// TB_MSG_NEXT. Remember to use a pointer variable that will survive the exiting and reentering of the time tick handler.
+#define TB_WAIT_MSG(_ptr) \
+        TB_WAIT_COND(TB_MSG_NEXT(_ptr))
+
+// TB_WAIT_MSG_W_DEADLINE waits for a message like TB_WAIT_MSG, or until the specified absolute time point, whichever
+// happens first. The pointer is set to NULL if the deadline occurred first.
+#define TB_WAIT_MSG_W_DEADLINE(_ptr, _time) \
+        TB_WAIT_COND_W_DEADLINE(TB_MSG_NEXT(_ptr), _time)
+
+// TB_WAIT_MSG_W_DEADLINE_DELTA waits for a message like TB_WAIT_MSG, or for the specified delay to elapse, whichever
+// happens first. The pointer is set to NULL if the delay elapsed first.
+#define TB_WAIT_MSG_W_DEADLINE_DELTA(_ptr, _delay) \
+        TB_WAIT_COND_W_DEADLINE_DELTA(TB_MSG_NEXT(_ptr), _delay)
+
+// Synchronization objects can be shared between test bench contexts (and event handlers) in the same process. Waiting
+// contexts are kept in a waiter list, and only those are woken up (via TB_SIGNAL_EVENT of their TB_TICK_HANDLER) when
+// the object is given/set/passed. Define them as global variables with the initializers below.
+// Example: tb_sem_t adv_sem = TB_SEM_INIT(0); tb_event_t conn_event = TB_EVENT_INIT; tb_barrier_t bar = TB_BARRIER_INIT(2);
+#define TB_SEM_INIT(_count) \
+    { .count = (_count), .waiters = { NULL, NULL } }
+#define TB_EVENT_INIT \
+    { .is_set = false, .waiters = { NULL, NULL } }
+#define TB_BARRIER_INIT(_nbr_parties) \
+    { .nbr_parties = (_nbr_parties), .nbr_arrived = 0, .waiters = { NULL, NULL } }
+
+// TB_SEM_TAKE waits until the specified semaphore count is non-zero, and decrements it. Waiting contexts take the
+// semaphore in the order they started waiting.
+#define TB_SEM_TAKE(_sem) \
+        tb_sem_take(tb_context_ptr, &(_sem), TB_PRINT_PREFIX, __FILE__, __LINE__); \
+        TB_WAIT_COND(tb_context_ptr->is_sync_granted)
+
+// TB_SEM_GIVE increments the specified semaphore count, or hands it directly to the first waiting context. Can also be
+// used outside test sequences, e.g. in event handlers.
+#define TB_SEM_GIVE(_sem) \
+        tb_sem_give(&(_sem));
+
+// TB_EVENT_WAIT waits until the specified event is set.
+#define TB_EVENT_WAIT(_event) \
+        tb_event_wait(tb_context_ptr, &(_event), TB_PRINT_PREFIX, __FILE__, __LINE__); \
+        TB_WAIT_COND(tb_context_ptr->is_sync_granted)
+
+// TB_EVENT_SET sets the specified event, waking up all contexts waiting for it. The event stays set until cleared by
+// TB_EVENT_CLEAR. Can also be used outside test sequences, e.g. in event handlers.
+#define TB_EVENT_SET(_event) \
+        tb_event_set(&(_event));
+
+// TB_EVENT_CLEAR clears the specified event.
+#define TB_EVENT_CLEAR(_event) \
+        (_event).is_set = false;
+
+// TB_BARRIER_WAIT waits until the number of contexts specified in TB_BARRIER_INIT have reached the specified barrier.
+// The barrier can then be reused.
+#define TB_BARRIER_WAIT(_barrier) \
+        tb_barrier_wait(tb_context_ptr, &(_barrier), TB_PRINT_PREFIX, __FILE__, __LINE__); \
+        TB_WAIT_COND(tb_context_ptr->is_sync_granted)
+
+// TB_WATCH defines a watched variable of the specified (scalar) type at file level. Written with TB_SET, it wakes the
+// contexts waiting for it with TB_WAIT_CHANGE or TB_WAIT_COND_WATCH when its value changes, so event handlers need not
+// call TB_SIGNAL_EVENT, and writes not changing the value or with nobody waiting cost only the compare. Like the
+// synchronization objects, waiting requires TB_TICK_HANDLER.
+// Example: TB_WATCH(unsigned int, nbr_rx);
+//          In the rx event handler: TB_SET(nbr_rx, nbr_rx + 1);
+//          In the test sequence: TB_WAIT_COND_WATCH(nbr_rx >= 3, nbr_rx);
+#define TB_WATCH(_type, _name) \
+    _type _name; \
+    tb_waiter_list_t _name##_tb_waiters = { NULL, NULL }
+
+// TB_WATCH_EXTERN declares a watched variable defined by TB_WATCH in another file.
+#define TB_WATCH_EXTERN(_type, _name) \
+    extern _type _name; \
+    extern tb_waiter_list_t _name##_tb_waiters
+
+// TB_SET sets the specified watched variable to the specified value, waking the contexts waiting for it if the value
+// changes. Can be used both in test sequences and outside them, e.g. in event handlers.
+#define TB_SET(_name, _val) \
+        { \
+            __typeof__(_name) tb_set_val = (_val); \
+            if (tb_set_val != (_name)) \
+            { \
+                (_name) = tb_set_val; \
+                if (_name##_tb_waiters.first) \
+                    tb_watch_changed(&_name##_tb_waiters); \
+            } \
+        }
+
+// TB_WAIT_CHANGE waits until the value of the specified watched variable is changed by TB_SET.
+#define TB_WAIT_CHANGE(_name) \
+        tb_watch_wait(tb_context_ptr, &_name##_tb_waiters, TB_PRINT_PREFIX, __FILE__, __LINE__); \
+        TB_WAIT_COND(tb_context_ptr->is_sync_granted)
+
+// TB_WAIT_COND_WATCH waits for the specified condition to become true, like TB_WAIT_COND, where the condition depends
+// only on the specified watched variable (and on variables not changing while waiting). The condition is only
+// re-checked when the watched variable changes, without TB_SIGNAL_EVENT.
+#define TB_WAIT_COND_WATCH(_cond, _name) \
+        TB_WAIT_COND(tb_watch_cond(tb_context_ptr, &_name##_tb_waiters, (_cond), TB_PRINT_PREFIX, __FILE__, __LINE__))
 
 // TB_IF and TB_ENDIF delimit a block of statements which are only executed if the specified condition is true.
 // TB_IF/TB_ENDIF blocks can be nested.
 #define TB_IF(_cond) \
-        tb_next_line = __LINE__; \
+        tb_resume_point->line = __LINE__; \
     } \
     TB_ASSERT(++tb_cur_blk_level < TB_MAX_BLK_LEVELS, "Too many nested blocks!"); \
     tb_blk_info[tb_cur_blk_level].blk_type = TB_BLK_TYPE_IF; \
-    if (tb_next_line == __LINE__ && !(_cond)) \
+    if (tb_resume_point->line == __LINE__ && !(_cond)) \
     { \
-        tb_next_line = TB_ELSE_OR_ENDIF_LINE; \
+        tb_resume_point->line = TB_ELSE_OR_ENDIF_LINE; \
         tb_next_blk_level = tb_cur_blk_level - 1; \
     } \
-    if (tb_next_line == __LINE__) \
-    {
+    if (tb_resume_point->line == __LINE__) \
+    { \
+        TB_COV_POINT
 
 // TB_ELSE is only allowed within a TB_IF/TB_ENDIF block, and causes the following statements to be executed only if
 // the associated TB_IF condition is false.
 #define TB_ELSE \
-        tb_next_line = __LINE__; \
+        tb_resume_point->line = __LINE__; \
     } \
     TB_ASSERT(tb_cur_blk_level > 0 && tb_blk_info[tb_cur_blk_level].blk_type == TB_BLK_TYPE_IF, \
         "TB_ELSE with no matching TB_IF!"); \
-    if (tb_next_line == __LINE__) \
+    if (tb_resume_point->line == __LINE__) \
     { \
-        tb_next_line = TB_END_LINE; \
+        tb_resume_point->line = TB_END_LINE; \
         tb_next_blk_level = tb_cur_blk_level - 1; \
     } \
-    else if (tb_next_line == TB_ELSE_OR_ENDIF_LINE && tb_next_blk_level == tb_cur_blk_level - 1) \
-    {
+    else if (tb_resume_point->line == TB_ELSE_OR_ENDIF_LINE && tb_next_blk_level == tb_cur_blk_level - 1) \
+    { \
+        TB_COV_POINT
 
 // TB_ELSIF is equivalent to a TB_ELSE followed by a TB_IF, but this TB_IF shares the same TB_ENDIF as the original
 // TB_IF associated with the TB_ELSE. Example: TB_IF() ... TB_ELSIF() ... TB_ELSIF() ... TB_ELSE ... TB_ENDIF.
 #define TB_ELSIF(_cond) \
-        tb_next_line = __LINE__; \
+        tb_resume_point->line = __LINE__; \
     } \
     TB_ASSERT(tb_cur_blk_level > 0 && tb_blk_info[tb_cur_blk_level].blk_type == TB_BLK_TYPE_IF, \
         "TB_ELSIF with no matching TB_IF!"); \
-    if (tb_next_line == __LINE__) \
+    if (tb_resume_point->line == __LINE__) \
     { \
-        tb_next_line = TB_END_LINE; \
+        tb_resume_point->line = TB_END_LINE; \
         tb_next_blk_level = tb_cur_blk_level - 1; \
     } \
-    else if (tb_next_line == TB_ELSE_OR_ENDIF_LINE && tb_next_blk_level == tb_cur_blk_level - 1 && (_cond)) \
-    {
+    else if (tb_resume_point->line == TB_ELSE_OR_ENDIF_LINE && tb_next_blk_level == tb_cur_blk_level - 1 && (_cond)) \
+    { \
+        TB_COV_POINT
 
 // TB_IF and TB_ENDIF delimit a block of statements which are only executed if the TB_IF condition is true.
 #define TB_ENDIF \
-        tb_next_line = __LINE__; \
+        tb_resume_point->line = __LINE__; \
     } \
     TB_ASSERT(tb_cur_blk_level > 0 && tb_blk_info[tb_cur_blk_level--].blk_type == TB_BLK_TYPE_IF, \
         "TB_ENDIF with no matching TB_IF!"); \
-    if (tb_next_line == __LINE__ || \
-        ((tb_next_line == TB_END_LINE || tb_next_line == TB_ELSE_OR_ENDIF_LINE) && tb_next_blk_level == tb_cur_blk_level)) \
-    {
+    if (tb_resume_point->line == __LINE__ || \
+        ((tb_resume_point->line == TB_END_LINE || tb_resume_point->line == TB_ELSE_OR_ENDIF_LINE) && tb_next_blk_level == tb_cur_blk_level)) \
+    { \
+        TB_COV_POINT
 
 // TB_WHILE and TB_ENDWHILE delimit a block of statements which are repeatedly executed as long as the specified
 // condition is true. If the condition is initially false, the block of statements is not executed at all.
 // TB_WHILE/TB_ENDWHILE blocks can be nested.
 #define TB_WHILE(_cond) \
-        tb_next_line = __LINE__; \
+        tb_resume_point->line = __LINE__; \
     } \
     TB_ASSERT(++tb_cur_blk_level < TB_MAX_BLK_LEVELS, "Too many nested blocks!"); \
     tb_blk_info[tb_cur_blk_level].blk_type = TB_BLK_TYPE_WHILE; \
     tb_blk_info[tb_cur_blk_level].first_line = __LINE__; \
-    if (tb_next_line == __LINE__ && !(_cond)) \
+    if (tb_resume_point->line == __LINE__ && !(_cond)) \
     { \
-        tb_next_line = TB_END_LINE; \
+        tb_resume_point->line = TB_END_LINE; \
         tb_next_blk_level = tb_cur_blk_level - 1; \
     } \
-    if (tb_next_line == __LINE__) \
-    {
+    if (tb_resume_point->line == __LINE__) \
+    { \
+        TB_COV_POINT
 
 // TB_WHILE and TB_ENDWHILE delimit a block of statements which are repeatedly executed as long as the TB_WHILE
 // condition is true.
 #define TB_ENDWHILE \
-        tb_next_line = __LINE__; \
+        tb_resume_point->line = __LINE__; \
     } \
     TB_ASSERT(tb_cur_blk_level > 0 && tb_blk_info[tb_cur_blk_level--].blk_type == TB_BLK_TYPE_WHILE, \
         "TB_ENDWHILE with no matching TB_WHILE!"); \
-    if (tb_next_line == __LINE__ || (tb_next_line == TB_LOOP_ITER_LINE && tb_next_blk_level == tb_cur_blk_level)) \
+    if (tb_resume_point->line == __LINE__ || (tb_resume_point->line == TB_LOOP_ITER_LINE && tb_next_blk_level == tb_cur_blk_level)) \
     { \
-        bst_ticker_set_next_tick_delta(0); \
-        tb_next_line = tb_blk_info[tb_cur_blk_level + 1].first_line; \
+        tb_context_ptr->nbr_loop_ticks++; \
+        tb_set_next_tick(tb_context_ptr, tm_get_hw_time()); \
+        tb_resume_point->line = tb_blk_info[tb_cur_blk_level + 1].first_line; \
         return; \
     } \
-    if (tb_next_line == TB_END_LINE && tb_next_blk_level == tb_cur_blk_level) \
-    {
+    if (tb_resume_point->line == TB_END_LINE && tb_next_blk_level == tb_cur_blk_level) \
+    { \
+        TB_COV_POINT
 
 // TB_FOR and TB_ENDFOR delimit a block of statements which are repeatedly executed as long as the specified condition
 // is true. If the condition is initially false, the block of statements is not executed at all. Additionally, TB_FOR
@@ -369,87 +1228,93 @@ typedef struct
 // TB_FOR/TB_ENDFOR blocks can be nested.
 #define TB_FOR(_init_expr, _cond, _iter_expr) \
         (_init_expr); \
-        tb_next_line = TB_LOOP_COND_LINE; \
+        tb_resume_point->line = TB_LOOP_COND_LINE; \
     } \
     TB_ASSERT(++tb_cur_blk_level < TB_MAX_BLK_LEVELS, "Too many nested blocks!"); \
     tb_blk_info[tb_cur_blk_level].blk_type = TB_BLK_TYPE_FOR; \
     tb_blk_info[tb_cur_blk_level].first_line = __LINE__; \
-    if (tb_next_line == __LINE__) \
+    if (tb_resume_point->line == __LINE__) \
     { \
         (_iter_expr); \
     } \
-    if (tb_next_line == TB_LOOP_COND_LINE) \
+    if (tb_resume_point->line == TB_LOOP_COND_LINE) \
     { \
-        tb_next_line = __LINE__; \
+        tb_resume_point->line = __LINE__; \
     } \
-    if (tb_next_line == __LINE__ && !(_cond)) \
+    if (tb_resume_point->line == __LINE__ && !(_cond)) \
     { \
-        tb_next_line = TB_END_LINE; \
+        tb_resume_point->line = TB_END_LINE; \
         tb_next_blk_level = tb_cur_blk_level - 1; \
     } \
-    if (tb_next_line == __LINE__) \
-    {
+    if (tb_resume_point->line == __LINE__) \
+    { \
+        TB_COV_POINT
 
 // TB_FOR and TB_ENDFOR delimit a block of statements which are repeatedly executed as long as the TB_FOR condition is
 // true.
 #define TB_ENDFOR \
-        tb_next_line = __LINE__; \
+        tb_resume_point->line = __LINE__; \
     } \
     TB_ASSERT(tb_cur_blk_level > 0 && tb_blk_info[tb_cur_blk_level--].blk_type == TB_BLK_TYPE_FOR, \
         "TB_ENDFOR with no matching TB_FOR!"); \
-    if (tb_next_line == __LINE__ || (tb_next_line == TB_LOOP_ITER_LINE && tb_next_blk_level == tb_cur_blk_level)) \
+    if (tb_resume_point->line == __LINE__ || (tb_resume_point->line == TB_LOOP_ITER_LINE && tb_next_blk_level == tb_cur_blk_level)) \
     { \
-        bst_ticker_set_next_tick_delta(0); \
-        tb_next_line = tb_blk_info[tb_cur_blk_level + 1].first_line; \
+        tb_context_ptr->nbr_loop_ticks++; \
+        tb_set_next_tick(tb_context_ptr, tm_get_hw_time()); \
+        tb_resume_point->line = tb_blk_info[tb_cur_blk_level + 1].first_line; \
         return; \
     } \
-    if (tb_next_line == TB_END_LINE && tb_next_blk_level == tb_cur_blk_level) \
-    {
+    if (tb_resume_point->line == TB_END_LINE && tb_next_blk_level == tb_cur_blk_level) \
+    { \
+        TB_COV_POINT
 
 // TB_REPEAT and TB_UNTIL delimit a block of statements which are repeatedly executed until the TB_UNTIL condition is
 // true. The block of statements will be executed at least once, as the condition is checked at the end of the block.
 // TB_REPEAT/TB_UNTIL blocks can be nested.
 #define TB_REPEAT \
-        tb_next_line = __LINE__; \
+        tb_resume_point->line = __LINE__; \
     } \
     TB_ASSERT(++tb_cur_blk_level < TB_MAX_BLK_LEVELS, "Too many nested blocks!"); \
     tb_blk_info[tb_cur_blk_level].blk_type = TB_BLK_TYPE_REPEAT; \
     tb_blk_info[tb_cur_blk_level].first_line = __LINE__; \
-    if (tb_next_line == __LINE__) \
-    {
+    if (tb_resume_point->line == __LINE__) \
+    { \
+        TB_COV_POINT
 
 // TB_REPEAT and TB_UNTIL delimit a block of statements which are repeatedly executed until the specified condition is
 // true.
 #define TB_UNTIL(_cond) \
-        tb_next_line = __LINE__; \
+        tb_resume_point->line = __LINE__; \
     } \
     TB_ASSERT(tb_cur_blk_level > 0 && tb_blk_info[tb_cur_blk_level--].blk_type == TB_BLK_TYPE_REPEAT, \
         "TB_UNTIL with no matching TB_REPEAT!"); \
-    if (tb_next_line == __LINE__ || (tb_next_line == TB_LOOP_ITER_LINE && tb_next_blk_level == tb_cur_blk_level)) \
+    if (tb_resume_point->line == __LINE__ || (tb_resume_point->line == TB_LOOP_ITER_LINE && tb_next_blk_level == tb_cur_blk_level)) \
     { \
         if (!(_cond)) \
         { \
-            bst_ticker_set_next_tick_delta(0); \
-            tb_next_line = tb_blk_info[tb_cur_blk_level + 1].first_line; \
+            tb_context_ptr->nbr_loop_ticks++; \
+            tb_set_next_tick(tb_context_ptr, tm_get_hw_time()); \
+            tb_resume_point->line = tb_blk_info[tb_cur_blk_level + 1].first_line; \
             return; \
         } \
-        tb_next_line = __LINE__; \
+        tb_resume_point->line = __LINE__; \
     } \
-    if (tb_next_line == __LINE__ || (tb_next_line == TB_END_LINE && tb_next_blk_level == tb_cur_blk_level)) \
-    {
+    if (tb_resume_point->line == __LINE__ || (tb_resume_point->line == TB_END_LINE && tb_next_blk_level == tb_cur_blk_level)) \
+    { \
+        TB_COV_POINT
 
 // TB_BREAK breaks out of a surrounding TB_WHILE, TB_FOR, or TB_REPEAT loop, and continues execution of the statements
 // following the end of the loop.
 #define TB_BREAK \
-        tb_next_line = __LINE__; \
+        tb_resume_point->line = __LINE__; \
     } \
     { \
         int i; \
         for (i = tb_cur_blk_level; i > 0 && !TB_BLK_TYPE_IS_LOOP(tb_blk_info[i].blk_type); i--); \
         TB_ASSERT(i > 0, "TB_BREAK not inside loop!"); \
-        if (tb_next_line == __LINE__) \
+        if (tb_resume_point->line == __LINE__) \
         { \
-            tb_next_line = TB_END_LINE; \
+            tb_resume_point->line = TB_END_LINE; \
             tb_next_blk_level = i - 1; \
         } \
     } \
@@ -459,15 +1324,15 @@ typedef struct
 // TB_CONTINUE jumps to the end of a surrounding TB_WHILE, TB_FOR, or TB_REPEAT loop, and proceeds with the next
 // loop iteration if any. Statements between the TB_CONTINUE and the end of the loop are skipped.
 #define TB_CONTINUE \
-        tb_next_line = __LINE__; \
+        tb_resume_point->line = __LINE__; \
     } \
     { \
         int i; \
         for (i = tb_cur_blk_level; i > 0 && !TB_BLK_TYPE_IS_LOOP(tb_blk_info[i].blk_type); i--); \
         TB_ASSERT(i > 0, "TB_CONTINUE not inside loop!"); \
-        if (tb_next_line == __LINE__) \
+        if (tb_resume_point->line == __LINE__) \
         { \
-            tb_next_line = TB_LOOP_ITER_LINE; \
+            tb_resume_point->line = TB_LOOP_ITER_LINE; \
             tb_next_blk_level = i - 1; \
         } \
     } \
@@ -480,21 +1345,67 @@ typedef struct
 // optionally followed by any user defined parameters. When the sub-test sequence in the called function completes,
 // execution continues with the statement following the TB_CALL. TB_CALLs can be nested.
 #define TB_CALL(_func, ...) \
-        tb_next_line = __LINE__; \
+        tb_resume_point->line = __LINE__; \
     } \
-    if (tb_next_line == __LINE__) \
+    if (tb_resume_point->line == __LINE__) \
     { \
+        if (++tb_context_ptr->call_depth >= TB_MAX_CALL_DEPTH) \
+            TB_ASSERT(!tb_context_ptr->resume_points, "Too many nested TB_CALLs in a batch!"); \
         (_func)(tb_context_ptr, ##__VA_ARGS__); \
+        tb_context_ptr->call_depth--; \
         if (!tb_context_ptr->is_func_done) \
             return; \
-        tb_context_ptr->is_func_done = false;
+        tb_context_ptr->is_func_done = false; \
+        TB_COV_POINT
+
+// TB_CALL_W_DEADLINE is like TB_CALL, but if the sub-test sequence has not completed by the specified absolute time
+// point, it is aborted: the resume points of the called function and of the functions it has called in turn are reset
+// (so they start over from TB_BEGIN when called again), its pending wait is cancelled, and execution continues with the
+// statement following the TB_CALL_W_DEADLINE. Use TB_CALL_TIMED_OUT to find out whether it was aborted. Timers,
+// messages, and TB_LOCALs of the aborted sequence are left as they are. TB_CALL_W_DEADLINEs can be nested.
+// Example: TB_CALL_W_DEADLINE(10e6, connect, peer_addr); TB_ASSERT(!TB_CALL_TIMED_OUT, "Connection hung");
+#define TB_CALL_W_DEADLINE(_time, _func, ...) \
+        tb_call_deadline_begin(tb_context_ptr, _time, TB_PRINT_PREFIX, __FILE__, __LINE__); \
+        tb_resume_point->line = __LINE__; \
+    } \
+    if (tb_resume_point->line == __LINE__) \
+    { \
+        if (tm_get_hw_time() >= tb_context_ptr->call_deadlines[tb_context_ptr->call_depth]) \
+            tb_call_abort(tb_context_ptr); \
+        else \
+        { \
+            tb_context_ptr->call_depth++; \
+            (_func)(tb_context_ptr, ##__VA_ARGS__); \
+            tb_context_ptr->call_depth--; \
+            if (!tb_context_ptr->is_func_done) \
+                return; \
+            tb_context_ptr->is_func_done = false; \
+            tb_call_deadline_end(tb_context_ptr); \
+        } \
+        TB_COV_POINT
+
+// TB_CALL_W_DEADLINE_DELTA is like TB_CALL_W_DEADLINE, with the deadline specified as a delay from the call.
+#define TB_CALL_W_DEADLINE_DELTA(_delay, _func, ...) \
+        TB_CALL_W_DEADLINE((_delay) + tm_get_hw_time(), _func, ##__VA_ARGS__)
+
+// TB_CALL_TIMED_OUT evaluates to true if the sub-test sequence of the last TB_CALL_W_DEADLINE was aborted at its
+// deadline.
+#define TB_CALL_TIMED_OUT \
+    (tb_context_ptr->is_call_timed_out)
 
 // TB_RETURN ends the current sub-test sequence and returns control to the calling function (the one that issued the
 // TB_CALL). If TB_RETURN is executed in the top level test sequence, the sequence ends (no new time tick is
 // scheduled). A (sub-)test sequence that does not encounter a TB_RETURN, ends/returns at TB_END.
 #define TB_RETURN \
+        if (tb_context_ptr->call_depth == 0) \
+        { \
+            if (TB_DEFER_CHECKPOINTS && tb_context_ptr->checkpoint_log && tb_context_ptr->checkpoint_log->nbr) \
+                tb_checkpoints_verify(tb_context_ptr, TB_PRINT_PREFIX); \
+            if (TB_RUN_SUMMARY) \
+                tb_run_summary(tb_context_ptr, TB_PRINT_PREFIX); \
+        } \
         tb_context_ptr->is_func_done = true; \
-        tb_next_line = 0; \
+        tb_resume_point->line = 0; \
         return;
 
 // TB_CONTEXT_PARAM must be specified as the first parameter when defining a function that is to be called by a
@@ -504,8 +1415,12 @@ typedef struct
 
 // TB_END ends the (sub-)test sequence. Should be the last statement in the tick handler or sub-test function.
 #define TB_END \
+        if (TB_DEFER_CHECKPOINTS && tb_context_ptr->checkpoint_log && tb_context_ptr->checkpoint_log->nbr) \
+            tb_checkpoints_verify(tb_context_ptr, TB_PRINT_PREFIX); \
+        if (TB_RUN_SUMMARY && tb_context_ptr->call_depth == 0) \
+            tb_run_summary(tb_context_ptr, TB_PRINT_PREFIX); \
         tb_context_ptr->is_func_done = true; \
-        tb_next_line = 0; \
+        tb_resume_point->line = 0; \
     } \
     TB_ASSERT(tb_cur_blk_level == 0, "TB_END inside block!");
 
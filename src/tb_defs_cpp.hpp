@@ -0,0 +1,90 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef TB_DEFS_CPP_HPP
+#define TB_DEFS_CPP_HPP
+
+// C++ wrapper of tb_defs.h, for test benches written in C++ (C++17 or later). Include it instead of tb_defs.h.
+//
+// TB_CHECKPOINT_SEQ and TB_CHECKPOINT_BUF_SEQ take the same lists as in C, e.g. TB_CHECKPOINT_SEQ({0,1}, {11.5e6,2}),
+// but the lists are constexpr and validated at compile time: the times must be whole, non-negative microseconds, in
+// non-decreasing order. So a mistake that in C is only found when the run reaches the checkpoint fails the build
+// instead. The validated lists are converted to the tb_checkpoint_t/tb_buf_checkpoint_t arrays at compile time, so,
+// like in C, they are read-only data that needs no preprocessing when the test starts.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "tb_defs.h"
+
+namespace tb_defs_cpp
+{
+
+// Checkpoint item as written in the list. The time is a double, so that e.g. 11.5e6 is accepted like in C.
+template <typename val_t>
+struct checkpoint_literal
+{
+    double time;
+    val_t val;
+};
+
+template <typename val_t, std::size_t nbr_items>
+constexpr bool are_times_whole_us(const checkpoint_literal<val_t> (&items)[nbr_items])
+{
+    for (std::size_t i = 0; i < nbr_items; i++)
+    {
+        // The range is checked first, as converting an out-of-range double is not a constant expression
+        if (!(items[i].time >= 0 && items[i].time < 18446744073709551616.0))
+            return false;
+        if (static_cast<double>(static_cast<bs_time_t>(items[i].time)) != items[i].time)
+            return false;
+    }
+    return true;
+}
+
+template <typename val_t, std::size_t nbr_items>
+constexpr bool are_times_sorted(const checkpoint_literal<val_t> (&items)[nbr_items])
+{
+    for (std::size_t i = 1; i < nbr_items; i++)
+        if (items[i].time < items[i - 1].time)
+            return false;
+    return true;
+}
+
+template <typename item_t, typename val_t, std::size_t nbr_items>
+constexpr std::array<item_t, nbr_items> to_items(const checkpoint_literal<val_t> (&items)[nbr_items])
+{
+    std::array<item_t, nbr_items> result{};
+    for (std::size_t i = 0; i < nbr_items; i++)
+        result[i] = item_t{ static_cast<bs_time_t>(items[i].time), items[i].val };
+    return result;
+}
+
+} // namespace tb_defs_cpp
+
+#undef TB_CHECKPOINT_SEQ
+#define TB_CHECKPOINT_SEQ(...) \
+    static constexpr tb_defs_cpp::checkpoint_literal<int> tb_checkpoint_literals[] = {__VA_ARGS__}; \
+    static_assert(tb_defs_cpp::are_times_whole_us(tb_checkpoint_literals), \
+        "TB_CHECKPOINT_SEQ: times must be whole, non-negative microseconds"); \
+    static_assert(tb_defs_cpp::are_times_sorted(tb_checkpoint_literals), \
+        "TB_CHECKPOINT_SEQ: times must be in non-decreasing order"); \
+    static constexpr auto tb_checkpoints = tb_defs_cpp::to_items<tb_checkpoint_t>(tb_checkpoint_literals); \
+    tb_context_ptr->checkpoints = tb_checkpoints.data(); \
+    tb_context_ptr->nbr_checkpoints = tb_checkpoints.size();
+
+#undef TB_CHECKPOINT_BUF_SEQ
+#define TB_CHECKPOINT_BUF_SEQ(...) \
+    static constexpr tb_defs_cpp::checkpoint_literal<uint64_t> tb_buf_checkpoint_literals[] = {__VA_ARGS__}; \
+    static_assert(tb_defs_cpp::are_times_whole_us(tb_buf_checkpoint_literals), \
+        "TB_CHECKPOINT_BUF_SEQ: times must be whole, non-negative microseconds"); \
+    static_assert(tb_defs_cpp::are_times_sorted(tb_buf_checkpoint_literals), \
+        "TB_CHECKPOINT_BUF_SEQ: times must be in non-decreasing order"); \
+    static constexpr auto tb_buf_checkpoints = \
+        tb_defs_cpp::to_items<tb_buf_checkpoint_t>(tb_buf_checkpoint_literals); \
+    tb_context_ptr->buf_checkpoints = tb_buf_checkpoints.data(); \
+    tb_context_ptr->nbr_buf_checkpoints = tb_buf_checkpoints.size();
+
+#endif // #ifndef TB_DEFS_CPP_HPP
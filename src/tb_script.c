@@ -0,0 +1,346 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// This file contains the loader and interpreter of test sequence scripts (see tb_script.h).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef TB_DEFS_ENV_HEADER
+// Alternative environment providing the BabbleSim API used below (e.g. the stand-ins used by the unit tests)
+#include TB_DEFS_ENV_HEADER
+#else
+#include "bs_types.h"
+#include "bs_tracing.h"
+// Provided by the device the test bench is linked with (normally declared in time_machine.h)
+bs_time_t tm_get_hw_time(void);
+#endif
+
+#include "tb_script.h"
+
+static bool tb_script_bind(tb_script_t *script, const tb_script_binding_t *bindings, unsigned int nbr_bindings,
+    char *err, size_t err_size)
+{
+    const tb_script_program_t *program = &script->program;
+    uint32_t i;
+    for (i = 0; i < program->nbr_names; i++)
+    {
+        const tb_script_name_t *name = &program->names[i];
+        unsigned int j;
+        if (name->kind != TB_SCRIPT_NAME_PRED && name->kind != TB_SCRIPT_NAME_ACTION)
+            continue;
+        for (j = 0; j < nbr_bindings; j++)
+        {
+            if (strcmp(bindings[j].name, name->str) != 0)
+                continue;
+            if (name->kind == TB_SCRIPT_NAME_PRED && bindings[j].pred)
+                script->preds[i] = bindings[j].pred;
+            if (name->kind == TB_SCRIPT_NAME_ACTION && bindings[j].action)
+                script->actions[i] = bindings[j].action;
+        }
+        if (script->preds[i] == NULL && script->actions[i] == NULL)
+        {
+            snprintf(err, err_size, "%s: No %s bound to the name %s", program->source,
+                name->kind == TB_SCRIPT_NAME_PRED ? "predicate" : "action", name->str);
+            return false;
+        }
+    }
+    return true;
+}
+
+tb_script_t *tb_script_load(const char *path, const tb_script_binding_t *bindings, unsigned int nbr_bindings,
+    const char *print_prefix)
+{
+    char err[256];
+    uint32_t i;
+    tb_script_t *script = calloc(1, sizeof(tb_script_t));
+
+    if (script == NULL)
+    {
+        tb_assert_failed(__FILE__, __LINE__, "%sTB_ASSERT failed: Out of memory for script %s\n", print_prefix, path);
+        return NULL;
+    }
+    if (!tb_script_read(path, &script->program, err, sizeof(err)))
+    {
+        free(script);
+        tb_assert_failed(__FILE__, __LINE__, "%sTB_ASSERT failed: %s\n", print_prefix, err);
+        return NULL;
+    }
+    script->print_prefix = print_prefix;
+    script->preds = calloc(script->program.nbr_names + 1, sizeof(script->preds[0]));
+    script->actions = calloc(script->program.nbr_names + 1, sizeof(script->actions[0]));
+    script->checkpoints = calloc(script->program.nbr_checkpoints + 1, sizeof(tb_checkpoint_t));
+    script->loop_counters = calloc(script->program.nbr_loop_counters + 1, sizeof(uint64_t));
+    if (script->preds == NULL || script->actions == NULL || script->checkpoints == NULL ||
+        script->loop_counters == NULL)
+    {
+        tb_script_free(script);
+        tb_assert_failed(__FILE__, __LINE__, "%sTB_ASSERT failed: Out of memory for script %s\n", print_prefix, path);
+        return NULL;
+    }
+    if (!tb_script_bind(script, bindings, nbr_bindings, err, sizeof(err)))
+    {
+        tb_script_free(script);
+        tb_assert_failed(__FILE__, __LINE__, "%sTB_ASSERT failed: %s\n", print_prefix, err);
+        return NULL;
+    }
+    for (i = 0; i < script->program.nbr_checkpoints; i++)
+    {
+        script->checkpoints[i].time = script->program.checkpoints[i].time;
+        script->checkpoints[i].val = script->program.checkpoints[i].val;
+    }
+    return script;
+}
+
+void tb_script_free(tb_script_t *script)
+{
+    if (script == NULL)
+        return;
+    tb_script_program_free(&script->program);
+    free(script->preds);
+    free(script->actions);
+    free(script->checkpoints);
+    free(script->loop_counters);
+    free(script);
+}
+
+static bool tb_script_pred(const tb_script_t *script, const tb_script_instr_t *instr)
+{
+    return script->preds[instr->a]() != (bool)instr->is_negated;
+}
+
+// Executes the instructions of the script from pc until it waits or ends
+static void tb_script_step(tb_context_t *context, tb_script_t *script)
+{
+    const tb_script_program_t *program = &script->program;
+
+    for (;;)
+    {
+        const tb_script_instr_t *instr = &program->instrs[script->pc];
+        switch (instr->op)
+        {
+        case TB_SCRIPT_OP_CHECKPOINT_SEQ:
+            if (program->nbr_checkpoints > 0)
+                context->checkpoint_idx = 0;
+            script->pc++;
+            break;
+
+        case TB_SCRIPT_OP_WAIT:
+            tb_set_next_tick(context, instr->t + tm_get_hw_time());
+            script->pc++;
+            return;
+
+        case TB_SCRIPT_OP_WAIT_UNTIL:
+            if (instr->t < tm_get_hw_time())
+                tb_wait_until_in_past(instr->t, script->print_prefix, program->source, instr->line);
+            tb_set_next_tick(context, instr->t);
+            script->pc++;
+            return;
+
+        case TB_SCRIPT_OP_WAIT_COND:
+            // Like TB_WAIT_COND, or TB_WAIT_COND_W_DEADLINE_DELTA if there is a deadline
+            if (instr->t == TB_SCRIPT_NO_DEADLINE)
+            {
+                if (!script->is_waiting)
+                {
+                    script->is_waiting = true;
+                    context->is_waiting_for_cond = true;
+                    if (context->timer_wheel || context->call_deadline_mask)
+                        tb_timers_update(context);
+                }
+                if (!tb_script_pred(script, instr))
+                    return;
+                context->is_waiting_for_cond = false;
+                if (context->timer_wheel)
+                    tb_timers_update(context);
+            }
+            else
+            {
+                if (!script->is_waiting)
+                {
+                    script->is_waiting = true;
+                    tb_wait_cond_begin(context, instr->t + tm_get_hw_time());
+                }
+                if (!tb_script_pred(script, instr) && tm_get_hw_time() < context->waiting_deadline)
+                    return;
+                tb_wait_cond_end(context);
+            }
+            script->is_waiting = false;
+            script->pc++;
+            break;
+
+        case TB_SCRIPT_OP_JUMP:
+            script->pc = instr->b;
+            break;
+
+        case TB_SCRIPT_OP_JUMP_IF_NOT:
+            script->pc = tb_script_pred(script, instr) ? script->pc + 1 : instr->b;
+            break;
+
+        case TB_SCRIPT_OP_FOR_INIT:
+            script->loop_counters[instr->a] = 0;
+            script->pc++;
+            break;
+
+        case TB_SCRIPT_OP_FOR_TEST:
+            script->pc = script->loop_counters[instr->a] < instr->t ? script->pc + 1 : instr->b;
+            break;
+
+        case TB_SCRIPT_OP_FOR_NEXT:
+            script->loop_counters[instr->a]++;
+            tb_set_next_tick(context, tm_get_hw_time());
+            script->pc = instr->b;
+            return;
+
+        case TB_SCRIPT_OP_LOOP:
+            tb_set_next_tick(context, tm_get_hw_time());
+            script->pc = instr->b;
+            return;
+
+        case TB_SCRIPT_OP_CALL:
+            if (script->call_depth == TB_SCRIPT_MAX_CALL_DEPTH)
+            {
+                tb_assert_failed(program->source, instr->line, "%sTB_ASSERT failed: Too many nested CALLs!\n",
+                    script->print_prefix);
+                return;
+            }
+            script->call_stack[script->call_depth++] = script->pc + 1;
+            script->pc = instr->b;
+            break;
+
+        case TB_SCRIPT_OP_RETURN:
+            if (script->call_depth > 0)
+            {
+                script->pc = script->call_stack[--script->call_depth];
+                break;
+            }
+            // A RETURN outside procedures ends the script
+            // fall through
+
+        case TB_SCRIPT_OP_END:
+            context->is_func_done = true;
+            script->pc = 0;
+            script->call_depth = 0;
+            return;
+
+        case TB_SCRIPT_OP_CHECKPOINT:
+        {
+            // Like TB_CHECKPOINT
+            int val = (int32_t)instr->t;
+            if (context->defer_checkpoints)
+            {
+                tb_checkpoint_log_t *log = context->checkpoint_log;
+                if (log && log->nbr < TB_CHECKPOINT_LOG_SIZE)
+                {
+                    log->times[log->nbr] = tm_get_hw_time();
+                    log->vals[log->nbr] = val;
+                    log->files[log->nbr] = program->source;
+                    log->lines[log->nbr++] = instr->line;
+                }
+                else
+                    tb_checkpoint_log_full(context, val, script->print_prefix, program->source, instr->line);
+            }
+            else
+            {
+                int idx = context->checkpoint_idx;
+                if (idx < context->nbr_checkpoints && context->checkpoints[idx].time == tm_get_hw_time() &&
+                    context->checkpoints[idx].val == val)
+                    context->checkpoint_idx = idx + 1;
+                else
+                    tb_checkpoint_failed(context, val, script->print_prefix, program->source, instr->line);
+            }
+            script->pc++;
+            break;
+        }
+
+        case TB_SCRIPT_OP_TEST_STEP:
+            bs_trace_raw_time(3, "%s### Test step: %s (%s line %u)\n", script->print_prefix,
+                program->names[instr->a].str, program->source, instr->line);
+            script->pc++;
+            break;
+
+        case TB_SCRIPT_OP_DO:
+            script->actions[instr->a]();
+            script->pc++;
+            break;
+
+        case TB_SCRIPT_OP_ASSERT:
+            if (!tb_script_pred(script, instr))
+                tb_assert_failed(program->source, instr->line, "%sTB_ASSERT failed: ASSERT %s%s\n",
+                    script->print_prefix, instr->is_negated ? "!" : "", program->names[instr->a].str);
+            script->pc++;
+            break;
+
+        default:
+            tb_assert_failed(program->source, instr->line, "%sTB_ASSERT failed: Invalid script instruction %u\n",
+                script->print_prefix, instr->op);
+            return;
+        }
+    }
+}
+
+void tb_script_run(tb_context_t *context, tb_script_t *script)
+{
+    unsigned int run_id = TB_CALL_RUN_ID(context);
+    const tb_checkpoint_t *caller_checkpoints;
+    int caller_nbr_checkpoints;
+    int caller_checkpoint_idx;
+
+    if (script->context != context)
+    {
+        if (script->context)
+        {
+            tb_assert_failed(__FILE__, __LINE__, "%sTB_ASSERT failed: Script run by more than one test bench "
+                "context (load it once per context)!\n", script->print_prefix);
+            return;
+        }
+        script->context = context;
+    }
+
+    // Like TB_BEGIN
+    context->is_func_done = false;
+    if (context->non_time_event_occurred)
+    {
+        if (!tb_resume_on_event(context))
+            return;
+    }
+    else if (context->next_tick_time <= tm_get_hw_time())
+        context->next_tick_time = TIME_NEVER;
+    if (context->timer_wheel)
+        tb_timers_update(context);
+    // Starts over after TB_RESET, or after being aborted by TB_CALL_W_DEADLINE
+    if (script->run_id != run_id)
+    {
+        script->run_id = run_id;
+        script->pc = 0;
+        script->call_depth = 0;
+        script->is_waiting = false;
+    }
+
+    // Without a CHECKPOINT_SEQ of its own, the script checks its CHECKPOINTs against the caller's TB_CHECKPOINT_SEQ
+    if (script->program.nbr_checkpoints == 0)
+    {
+        tb_script_step(context, script);
+        return;
+    }
+    // Otherwise against its own, which is only installed while it runs, as the caller may install its own at every
+    // entry. Deferred checkpoints are verified before the sequence is switched, against the one they were logged for.
+    if (context->checkpoint_log && context->checkpoint_log->nbr)
+        tb_checkpoints_verify(context, script->print_prefix);
+    caller_checkpoints = context->checkpoints;
+    caller_nbr_checkpoints = context->nbr_checkpoints;
+    caller_checkpoint_idx = context->checkpoint_idx;
+    context->checkpoints = script->checkpoints;
+    context->nbr_checkpoints = script->program.nbr_checkpoints;
+    context->checkpoint_idx = script->checkpoint_idx;
+    tb_script_step(context, script);
+    if (context->checkpoint_log && context->checkpoint_log->nbr)
+        tb_checkpoints_verify(context, script->print_prefix);
+    script->checkpoint_idx = context->checkpoint_idx;
+    context->checkpoints = caller_checkpoints;
+    context->nbr_checkpoints = caller_nbr_checkpoints;
+    context->checkpoint_idx = caller_checkpoint_idx;
+}
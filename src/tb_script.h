@@ -0,0 +1,104 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef TB_SCRIPT_H
+#define TB_SCRIPT_H
+
+// This file provides test sequences loaded at run time from script files, so that test scenarios can be written and
+// swapped without rebuilding the test bench. A script is either text (see tb_script_compiler.h for the syntax) or
+// compiled ahead of time by the tb_script_compile tool, and is compiled to bytecode when loaded. The interpreter runs it
+// as a sub-test sequence with the same scheduling as the tb_defs.h macros: WAIT schedules a time tick, WAIT_COND waits
+// for TB_SIGNAL_EVENT, loops iterate through a zero delay tick like TB_ENDFOR, CHECKPOINT checks against the
+// CHECKPOINT_SEQ of the script, etc. It keeps the index of the next instruction, so it resumes directly where it left off.
+//
+// A script with a CHECKPOINT_SEQ checks its CHECKPOINTs against it from the start each time it is run, independently of
+// the TB_CHECKPOINT_SEQ of the calling sequence; without one, its CHECKPOINTs continue the caller's sequence, like the
+// TB_CHECKPOINTs of a sub-test function. TB_DEFER_CHECKPOINTS applies to them like to TB_CHECKPOINT.
+//
+// The predicates (for WAIT_COND, IF, WHILE, and ASSERT) and actions (for DO) of a script are C functions of the test
+// bench, bound by name when the script is loaded:
+//
+// static bool is_rx_done(void) { return nbr_rx_packets > 0; }
+// static void send_packet(void) { ... }
+// static const tb_script_binding_t bindings[] = { TB_SCRIPT_PRED(is_rx_done), TB_SCRIPT_ACTION(send_packet) };
+// static tb_script_t *script;
+//
+// In the initialization: script = TB_SCRIPT_LOAD(argv[1], bindings);
+//
+// void test_tick(bs_time_t HW_device_time)
+// {
+//     TB_BEGIN
+//     TB_SCRIPT(script);
+//     TB_END
+// }
+//
+// TB_SCRIPT is a TB_CALL, so a script can also be run under a deadline with TB_CALL_W_DEADLINE(_time, tb_script_run,
+// script), and starts over after TB_RESET.
+//
+// The state of a running script (next instruction, loop counters, etc.) is kept in the loaded script, so a loaded script
+// can only be run by one test bench context. Load it once per context, e.g. per batch instance.
+
+#include "tb_defs.h"
+#include "tb_script_compiler.h"
+
+#ifndef TB_SCRIPT_MAX_CALL_DEPTH
+#define TB_SCRIPT_MAX_CALL_DEPTH 16
+#endif
+
+typedef struct
+{
+    const char *name;
+    bool (*pred)(void);
+    void (*action)(void);
+} tb_script_binding_t;
+
+typedef struct
+{
+    tb_script_program_t program;
+    const char *print_prefix;
+    bool (**preds)(void);                           // Per name of the program
+    void (**actions)(void);                         // Per name of the program
+    tb_checkpoint_t *checkpoints;
+    tb_context_t *context;                          // Context running the script (NULL until first run)
+    uint64_t *loop_counters;
+    uint32_t pc;                                    // Next instruction
+    uint32_t call_stack[TB_SCRIPT_MAX_CALL_DEPTH];  // Return instructions of the CALLs
+    unsigned int call_depth;
+    bool is_waiting;                                // The WAIT_COND at pc has started waiting
+    int checkpoint_idx;                             // Next item of the CHECKPOINT_SEQ (kept while the caller runs)
+    unsigned int run_id;
+} tb_script_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+tb_script_t *tb_script_load(const char *path, const tb_script_binding_t *bindings, unsigned int nbr_bindings,
+    const char *print_prefix);
+void tb_script_free(tb_script_t *script);
+void tb_script_run(tb_context_t *context, tb_script_t *script);
+#ifdef __cplusplus
+}
+#endif
+
+// TB_SCRIPT_PRED and TB_SCRIPT_ACTION bind a predicate (bool (*)(void)) or action (void (*)(void)) function to its name
+// in scripts.
+#define TB_SCRIPT_PRED(_func) \
+    { #_func, _func, NULL }
+
+#define TB_SCRIPT_ACTION(_func) \
+    { #_func, NULL, _func }
+
+// TB_SCRIPT_LOAD loads the script (text or compiled) from the specified file, with the specified array of bindings, and
+// evaluates to the loaded script. The test fails if the script cannot be read or compiled, or uses a predicate or
+// action that is not bound.
+#define TB_SCRIPT_LOAD(_path, _bindings) \
+    tb_script_load(_path, _bindings, sizeof(_bindings)/sizeof((_bindings)[0]), TB_PRINT_PREFIX)
+
+// TB_SCRIPT runs the specified loaded script as a sub-test sequence. When the script ends, execution continues with the
+// statement following the TB_SCRIPT.
+#define TB_SCRIPT(_script) \
+        TB_CALL(tb_script_run, _script)
+
+#endif // #ifndef TB_SCRIPT_H
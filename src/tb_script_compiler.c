@@ -0,0 +1,862 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// This file contains the compiler of the test sequence script text syntax into bytecode, and the reading and writing of
+// compiled scripts (see tb_script_compiler.h).
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tb_script_compiler.h"
+
+#define TB_SCRIPT_MAGIC "TBSCRIPT"
+#define TB_SCRIPT_VERSION 1
+#define TB_SCRIPT_MAX_BLK_LEVELS 64
+#define TB_SCRIPT_MAX_TOKEN_LEN 256
+// End of a chain of jumps still to be patched; the chain is linked through the jump targets
+#define TB_SCRIPT_NO_INSTR UINT32_MAX
+
+typedef enum
+{
+    TB_SCRIPT_BLK_IF,
+    TB_SCRIPT_BLK_FOR,
+    TB_SCRIPT_BLK_WHILE,
+    TB_SCRIPT_BLK_PROC,
+} tb_script_blk_type_t;
+
+typedef struct
+{
+    tb_script_blk_type_t type;
+    unsigned int line;
+    uint32_t loop_start;            // Loop condition instruction
+    uint32_t cond_jump;             // Jump of the false condition of the current IF branch
+    uint32_t end_chain;             // Jumps to the end of the block
+    uint32_t continue_chain;        // Jumps to the loop iteration
+    uint32_t loop_counter;
+    bool has_else;
+} tb_script_blk_t;
+
+typedef struct
+{
+    const char *source;
+    unsigned int line;
+    char *err;
+    size_t err_size;
+    tb_script_program_t *program;
+    uint32_t instrs_capacity;
+    uint32_t names_capacity;
+    uint32_t checkpoints_capacity;
+    tb_script_blk_t blks[TB_SCRIPT_MAX_BLK_LEVELS];
+    unsigned int nbr_blks;
+    uint32_t *proc_addrs;           // Per name; TB_SCRIPT_NO_INSTR if not a defined procedure
+} tb_script_compiler_t;
+
+static bool tb_script_error(tb_script_compiler_t *comp, const char *fmt_str, ...)
+{
+    va_list variable_args;
+    int len = snprintf(comp->err, comp->err_size, "%s:%u: ", comp->source, comp->line);
+    va_start(variable_args, fmt_str);
+    if (len >= 0 && (size_t)len < comp->err_size)
+        vsnprintf(comp->err + len, comp->err_size - len, fmt_str, variable_args);
+    va_end(variable_args);
+    return false;
+}
+
+static char *tb_script_strdup(const char *str)
+{
+    char *dup = malloc(strlen(str) + 1);
+    if (dup)
+        strcpy(dup, str);
+    return dup;
+}
+
+static bool tb_script_grow(tb_script_compiler_t *comp, void **array, uint32_t *capacity, uint32_t nbr,
+    size_t item_size)
+{
+    void *grown;
+    uint32_t new_capacity;
+    if (nbr < *capacity)
+        return true;
+    new_capacity = *capacity ? 2 * *capacity : 16;
+    grown = realloc(*array, new_capacity * item_size);
+    if (grown == NULL)
+        return tb_script_error(comp, "Out of memory");
+    *array = grown;
+    *capacity = new_capacity;
+    return true;
+}
+
+static bool tb_script_emit(tb_script_compiler_t *comp, tb_script_op_t op, uint32_t a, uint32_t b, uint64_t t)
+{
+    tb_script_program_t *program = comp->program;
+    tb_script_instr_t *instr;
+    if (!tb_script_grow(comp, (void **)&program->instrs, &comp->instrs_capacity, program->nbr_instrs,
+        sizeof(tb_script_instr_t)))
+        return false;
+    instr = &program->instrs[program->nbr_instrs++];
+    memset(instr, 0, sizeof(*instr));
+    instr->op = op;
+    instr->line = comp->line;
+    instr->a = a;
+    instr->b = b;
+    instr->t = t;
+    return true;
+}
+
+static uint32_t tb_script_last_instr(const tb_script_compiler_t *comp)
+{
+    return comp->program->nbr_instrs - 1;
+}
+
+// Adds a jump to a chain of jumps to be patched when the target is known
+static bool tb_script_emit_chained(tb_script_compiler_t *comp, tb_script_op_t op, uint32_t a, uint32_t *chain)
+{
+    if (!tb_script_emit(comp, op, a, *chain, 0))
+        return false;
+    *chain = tb_script_last_instr(comp);
+    return true;
+}
+
+static void tb_script_patch_chain(tb_script_compiler_t *comp, uint32_t chain, uint32_t target)
+{
+    while (chain != TB_SCRIPT_NO_INSTR)
+    {
+        uint32_t next = comp->program->instrs[chain].b;
+        comp->program->instrs[chain].b = target;
+        chain = next;
+    }
+}
+
+static bool tb_script_add_name(tb_script_compiler_t *comp, const char *str, tb_script_name_kind_t kind,
+    uint32_t *idx)
+{
+    tb_script_program_t *program = comp->program;
+    uint32_t names_capacity = comp->names_capacity;
+    uint32_t i;
+    for (i = 0; i < program->nbr_names; i++)
+    {
+        if (program->names[i].kind == kind && strcmp(program->names[i].str, str) == 0)
+        {
+            *idx = i;
+            return true;
+        }
+    }
+    if (!tb_script_grow(comp, (void **)&program->names, &comp->names_capacity, program->nbr_names,
+        sizeof(tb_script_name_t)))
+        return false;
+    if (comp->names_capacity != names_capacity)
+    {
+        uint32_t *grown = realloc(comp->proc_addrs, comp->names_capacity * sizeof(uint32_t));
+        if (grown == NULL)
+            return tb_script_error(comp, "Out of memory");
+        comp->proc_addrs = grown;
+    }
+    program->names[i].str = tb_script_strdup(str);
+    if (program->names[i].str == NULL)
+        return tb_script_error(comp, "Out of memory");
+    program->names[i].kind = kind;
+    comp->proc_addrs[i] = TB_SCRIPT_NO_INSTR;
+    program->nbr_names++;
+    *idx = i;
+    return true;
+}
+
+static const char *tb_script_skip_space(const char *p)
+{
+    while (*p == ' ' || *p == '\t' || *p == '\r')
+        p++;
+    return p;
+}
+
+// Reads the next whitespace delimited token, or quoted string (without the quotes)
+static bool tb_script_next_token(tb_script_compiler_t *comp, const char **p, char *token, bool *is_quoted)
+{
+    size_t len = 0;
+    const char *s = tb_script_skip_space(*p);
+    *is_quoted = (*s == '"');
+    if (*is_quoted)
+    {
+        for (s++; *s != '"'; s++)
+        {
+            if (*s == '\0' || *s == '\n')
+                return tb_script_error(comp, "Missing closing quote");
+            if (*s == '\\' && s[1] != '\0' && s[1] != '\n')
+                s++;
+            if (len == TB_SCRIPT_MAX_TOKEN_LEN - 1)
+                return tb_script_error(comp, "String too long");
+            token[len++] = *s;
+        }
+        s++;
+    }
+    else
+    {
+        for (; *s != '\0' && !isspace((unsigned char)*s) && *s != '#'; s++)
+        {
+            if (len == TB_SCRIPT_MAX_TOKEN_LEN - 1)
+                return tb_script_error(comp, "Token too long");
+            token[len++] = *s;
+        }
+    }
+    token[len] = '\0';
+    *p = s;
+    return true;
+}
+
+static bool tb_script_is_end_of_line(const char *p)
+{
+    p = tb_script_skip_space(p);
+    return *p == '\0' || *p == '\n' || *p == '#';
+}
+
+static bool tb_script_parse_time(tb_script_compiler_t *comp, const char *token, uint64_t *time)
+{
+    char *end;
+    double val;
+    errno = 0;
+    val = strtod(token, &end);
+    if (end == token || *end != '\0' || errno != 0)
+        return tb_script_error(comp, "Invalid number '%s'", token);
+    if (!(val >= 0 && val < 18446744073709551616.0) || (double)(uint64_t)val != val)
+        return tb_script_error(comp, "'%s' is not a whole, non-negative number of microseconds", token);
+    *time = (uint64_t)val;
+    return true;
+}
+
+static bool tb_script_parse_val(tb_script_compiler_t *comp, const char *token, int32_t *val)
+{
+    char *end;
+    long parsed;
+    errno = 0;
+    parsed = strtol(token, &end, 0);
+    if (end == token || *end != '\0' || errno != 0 || parsed < INT32_MIN || parsed > INT32_MAX)
+        return tb_script_error(comp, "Invalid checkpoint value '%s'", token);
+    *val = (int32_t)parsed;
+    return true;
+}
+
+static bool tb_script_parse_pred(tb_script_compiler_t *comp, const char **p, uint32_t *idx, bool *is_negated)
+{
+    char token[TB_SCRIPT_MAX_TOKEN_LEN];
+    bool is_quoted;
+    const char *name = token;
+    if (!tb_script_next_token(comp, p, token, &is_quoted))
+        return false;
+    *is_negated = (token[0] == '!');
+    if (*is_negated)
+        name++;
+    if (is_quoted || name[0] == '\0')
+        return tb_script_error(comp, "Missing predicate");
+    return tb_script_add_name(comp, name, TB_SCRIPT_NAME_PRED, idx);
+}
+
+// Emits an instruction taking a predicate
+static bool tb_script_emit_pred(tb_script_compiler_t *comp, const char **p, tb_script_op_t op, uint32_t b,
+    uint64_t t)
+{
+    uint32_t idx;
+    bool is_negated;
+    if (!tb_script_parse_pred(comp, p, &idx, &is_negated) || !tb_script_emit(comp, op, idx, b, t))
+        return false;
+    comp->program->instrs[tb_script_last_instr(comp)].is_negated = is_negated;
+    return true;
+}
+
+static bool tb_script_parse_checkpoint_seq(tb_script_compiler_t *comp, const char *p)
+{
+    tb_script_program_t *program = comp->program;
+    while (!tb_script_is_end_of_line(p))
+    {
+        char token[TB_SCRIPT_MAX_TOKEN_LEN];
+        tb_script_checkpoint_t *checkpoint;
+        size_t len;
+        const char *comma;
+        const char *close;
+
+        p = tb_script_skip_space(p);
+        comma = strchr(p, ',');
+        close = comma ? strchr(comma, '}') : NULL;
+        if (*p != '{' || close == NULL)
+            return tb_script_error(comp, "Expected {<time>,<value>}");
+        if (!tb_script_grow(comp, (void **)&program->checkpoints, &comp->checkpoints_capacity,
+            program->nbr_checkpoints, sizeof(tb_script_checkpoint_t)))
+            return false;
+        checkpoint = &program->checkpoints[program->nbr_checkpoints];
+
+        p = tb_script_skip_space(p + 1);
+        len = comma - p;
+        while (len > 0 && isspace((unsigned char)p[len - 1]))
+            len--;
+        if (len >= sizeof(token))
+            return tb_script_error(comp, "Token too long");
+        memcpy(token, p, len);
+        token[len] = '\0';
+        if (!tb_script_parse_time(comp, token, &checkpoint->time))
+            return false;
+
+        p = tb_script_skip_space(comma + 1);
+        len = close - p;
+        while (len > 0 && isspace((unsigned char)p[len - 1]))
+            len--;
+        if (len >= sizeof(token))
+            return tb_script_error(comp, "Token too long");
+        memcpy(token, p, len);
+        token[len] = '\0';
+        if (!tb_script_parse_val(comp, token, &checkpoint->val))
+            return false;
+
+        if (program->nbr_checkpoints > 0 && checkpoint->time < program->checkpoints[program->nbr_checkpoints - 1].time)
+            return tb_script_error(comp, "CHECKPOINT_SEQ times must be in non-decreasing order");
+        program->nbr_checkpoints++;
+        p = close + 1;
+    }
+    return true;
+}
+
+static bool tb_script_push_blk(tb_script_compiler_t *comp, tb_script_blk_type_t type, tb_script_blk_t **blk)
+{
+    if (comp->nbr_blks == TB_SCRIPT_MAX_BLK_LEVELS)
+        return tb_script_error(comp, "Too many nested blocks");
+    *blk = &comp->blks[comp->nbr_blks++];
+    memset(*blk, 0, sizeof(**blk));
+    (*blk)->type = type;
+    (*blk)->line = comp->line;
+    (*blk)->loop_start = TB_SCRIPT_NO_INSTR;
+    (*blk)->cond_jump = TB_SCRIPT_NO_INSTR;
+    (*blk)->end_chain = TB_SCRIPT_NO_INSTR;
+    (*blk)->continue_chain = TB_SCRIPT_NO_INSTR;
+    return true;
+}
+
+static tb_script_blk_t *tb_script_top_blk(tb_script_compiler_t *comp, tb_script_blk_type_t type)
+{
+    if (comp->nbr_blks == 0 || comp->blks[comp->nbr_blks - 1].type != type)
+        return NULL;
+    return &comp->blks[comp->nbr_blks - 1];
+}
+
+static tb_script_blk_t *tb_script_innermost_loop(tb_script_compiler_t *comp)
+{
+    unsigned int i;
+    for (i = comp->nbr_blks; i > 0; i--)
+    {
+        tb_script_blk_type_t type = comp->blks[i - 1].type;
+        if (type == TB_SCRIPT_BLK_PROC)
+            break;
+        if (type == TB_SCRIPT_BLK_FOR || type == TB_SCRIPT_BLK_WHILE)
+            return &comp->blks[i - 1];
+    }
+    return NULL;
+}
+
+static bool tb_script_is_in_proc(const tb_script_compiler_t *comp)
+{
+    return comp->nbr_blks > 0 && comp->blks[0].type == TB_SCRIPT_BLK_PROC;
+}
+
+static bool tb_script_compile_stmt(tb_script_compiler_t *comp, const char *keyword, const char *p)
+{
+    tb_script_program_t *program = comp->program;
+    char token[TB_SCRIPT_MAX_TOKEN_LEN];
+    bool is_quoted;
+    tb_script_blk_t *blk;
+    uint32_t idx;
+    uint64_t time;
+
+    if (strcmp(keyword, "CHECKPOINT_SEQ") == 0)
+        return tb_script_parse_checkpoint_seq(comp, p);
+
+    if (strcmp(keyword, "TEST_STEP") == 0)
+    {
+        if (!tb_script_next_token(comp, &p, token, &is_quoted))
+            return false;
+        if (!is_quoted)
+            return tb_script_error(comp, "Expected quoted text");
+        if (!tb_script_add_name(comp, token, TB_SCRIPT_NAME_TEXT, &idx))
+            return false;
+        if (!tb_script_is_end_of_line(p))
+            return tb_script_error(comp, "Unexpected text after the statement");
+        return tb_script_emit(comp, TB_SCRIPT_OP_TEST_STEP, idx, 0, 0);
+    }
+
+    // All remaining statements have unquoted arguments, checked for extra text at the end
+    if (strcmp(keyword, "WAIT") == 0 || strcmp(keyword, "WAIT_UNTIL") == 0)
+    {
+        if (!tb_script_next_token(comp, &p, token, &is_quoted) || !tb_script_parse_time(comp, token, &time))
+            return false;
+        if (!tb_script_emit(comp, keyword[4] == '\0' ? TB_SCRIPT_OP_WAIT : TB_SCRIPT_OP_WAIT_UNTIL, 0, 0, time))
+            return false;
+    }
+    else if (strcmp(keyword, "WAIT_COND") == 0)
+    {
+        bool is_negated;
+        if (!tb_script_parse_pred(comp, &p, &idx, &is_negated))
+            return false;
+        time = TB_SCRIPT_NO_DEADLINE;
+        if (!tb_script_is_end_of_line(p))
+        {
+            if (!tb_script_next_token(comp, &p, token, &is_quoted) || !tb_script_parse_time(comp, token, &time))
+                return false;
+            if (time == TB_SCRIPT_NO_DEADLINE)
+                return tb_script_error(comp, "Deadline delay too large");
+        }
+        if (!tb_script_emit(comp, TB_SCRIPT_OP_WAIT_COND, idx, 0, time))
+            return false;
+        program->instrs[tb_script_last_instr(comp)].is_negated = is_negated;
+    }
+    else if (strcmp(keyword, "CHECKPOINT") == 0)
+    {
+        int32_t val;
+        if (!tb_script_next_token(comp, &p, token, &is_quoted) || !tb_script_parse_val(comp, token, &val))
+            return false;
+        if (!tb_script_emit(comp, TB_SCRIPT_OP_CHECKPOINT, 0, 0, (uint64_t)(int64_t)val))
+            return false;
+    }
+    else if (strcmp(keyword, "ASSERT") == 0)
+    {
+        if (!tb_script_emit_pred(comp, &p, TB_SCRIPT_OP_ASSERT, 0, 0))
+            return false;
+    }
+    else if (strcmp(keyword, "DO") == 0)
+    {
+        if (!tb_script_next_token(comp, &p, token, &is_quoted))
+            return false;
+        if (is_quoted || token[0] == '\0')
+            return tb_script_error(comp, "Missing action");
+        if (!tb_script_add_name(comp, token, TB_SCRIPT_NAME_ACTION, &idx) ||
+            !tb_script_emit(comp, TB_SCRIPT_OP_DO, idx, 0, 0))
+            return false;
+    }
+    else if (strcmp(keyword, "IF") == 0)
+    {
+        if (!tb_script_push_blk(comp, TB_SCRIPT_BLK_IF, &blk) ||
+            !tb_script_emit_pred(comp, &p, TB_SCRIPT_OP_JUMP_IF_NOT, TB_SCRIPT_NO_INSTR, 0))
+            return false;
+        blk->cond_jump = tb_script_last_instr(comp);
+    }
+    else if (strcmp(keyword, "ELSIF") == 0 || strcmp(keyword, "ELSE") == 0)
+    {
+        blk = tb_script_top_blk(comp, TB_SCRIPT_BLK_IF);
+        if (blk == NULL || blk->has_else)
+            return tb_script_error(comp, "%s with no matching IF", keyword);
+        // The previous branch ends by jumping to ENDIF, and its false condition jumps here
+        if (!tb_script_emit_chained(comp, TB_SCRIPT_OP_JUMP, 0, &blk->end_chain))
+            return false;
+        tb_script_patch_chain(comp, blk->cond_jump, program->nbr_instrs);
+        blk->cond_jump = TB_SCRIPT_NO_INSTR;
+        if (strcmp(keyword, "ELSE") == 0)
+            blk->has_else = true;
+        else
+        {
+            if (!tb_script_emit_pred(comp, &p, TB_SCRIPT_OP_JUMP_IF_NOT, TB_SCRIPT_NO_INSTR, 0))
+                return false;
+            blk->cond_jump = tb_script_last_instr(comp);
+        }
+    }
+    else if (strcmp(keyword, "ENDIF") == 0)
+    {
+        blk = tb_script_top_blk(comp, TB_SCRIPT_BLK_IF);
+        if (blk == NULL)
+            return tb_script_error(comp, "ENDIF with no matching IF");
+        tb_script_patch_chain(comp, blk->cond_jump, program->nbr_instrs);
+        tb_script_patch_chain(comp, blk->end_chain, program->nbr_instrs);
+        comp->nbr_blks--;
+    }
+    else if (strcmp(keyword, "FOR") == 0)
+    {
+        if (!tb_script_next_token(comp, &p, token, &is_quoted) || !tb_script_parse_time(comp, token, &time))
+            return false;
+        if (!tb_script_push_blk(comp, TB_SCRIPT_BLK_FOR, &blk))
+            return false;
+        // Each loop has its own counter, like the static loop variable of a TB_FOR
+        blk->loop_counter = program->nbr_loop_counters++;
+        if (!tb_script_emit(comp, TB_SCRIPT_OP_FOR_INIT, blk->loop_counter, 0, 0) ||
+            !tb_script_emit_chained(comp, TB_SCRIPT_OP_FOR_TEST, blk->loop_counter, &blk->end_chain))
+            return false;
+        blk->loop_start = tb_script_last_instr(comp);
+        program->instrs[blk->loop_start].t = time;
+    }
+    else if (strcmp(keyword, "ENDFOR") == 0 || strcmp(keyword, "ENDWHILE") == 0)
+    {
+        bool is_for = (keyword[3] == 'F');
+        blk = tb_script_top_blk(comp, is_for ? TB_SCRIPT_BLK_FOR : TB_SCRIPT_BLK_WHILE);
+        if (blk == NULL)
+            return tb_script_error(comp, "%s with no matching %s", keyword, is_for ? "FOR" : "WHILE");
+        tb_script_patch_chain(comp, blk->continue_chain, program->nbr_instrs);
+        if (!tb_script_emit(comp, is_for ? TB_SCRIPT_OP_FOR_NEXT : TB_SCRIPT_OP_LOOP, blk->loop_counter,
+            blk->loop_start, 0))
+            return false;
+        tb_script_patch_chain(comp, blk->end_chain, program->nbr_instrs);
+        comp->nbr_blks--;
+    }
+    else if (strcmp(keyword, "WHILE") == 0)
+    {
+        if (!tb_script_push_blk(comp, TB_SCRIPT_BLK_WHILE, &blk) ||
+            !tb_script_emit_pred(comp, &p, TB_SCRIPT_OP_JUMP_IF_NOT, TB_SCRIPT_NO_INSTR, 0))
+            return false;
+        blk->loop_start = tb_script_last_instr(comp);
+        blk->end_chain = blk->loop_start;
+    }
+    else if (strcmp(keyword, "BREAK") == 0 || strcmp(keyword, "CONTINUE") == 0)
+    {
+        blk = tb_script_innermost_loop(comp);
+        if (blk == NULL)
+            return tb_script_error(comp, "%s not inside loop", keyword);
+        if (!tb_script_emit_chained(comp, TB_SCRIPT_OP_JUMP, 0,
+            keyword[0] == 'B' ? &blk->end_chain : &blk->continue_chain))
+            return false;
+    }
+    else if (strcmp(keyword, "PROC") == 0)
+    {
+        if (comp->nbr_blks > 0)
+            return tb_script_error(comp, "PROC inside block");
+        if (!tb_script_next_token(comp, &p, token, &is_quoted))
+            return false;
+        if (is_quoted || token[0] == '\0')
+            return tb_script_error(comp, "Missing procedure name");
+        if (!tb_script_add_name(comp, token, TB_SCRIPT_NAME_PROC, &idx))
+            return false;
+        if (comp->proc_addrs[idx] != TB_SCRIPT_NO_INSTR)
+            return tb_script_error(comp, "Procedure %s already defined", token);
+        // The main sequence jumps over the procedure
+        if (!tb_script_push_blk(comp, TB_SCRIPT_BLK_PROC, &blk) ||
+            !tb_script_emit_chained(comp, TB_SCRIPT_OP_JUMP, 0, &blk->end_chain))
+            return false;
+        comp->proc_addrs[idx] = program->nbr_instrs;
+    }
+    else if (strcmp(keyword, "ENDPROC") == 0)
+    {
+        blk = tb_script_top_blk(comp, TB_SCRIPT_BLK_PROC);
+        if (blk == NULL)
+            return tb_script_error(comp, "ENDPROC with no matching PROC");
+        if (!tb_script_emit(comp, TB_SCRIPT_OP_RETURN, 0, 0, 0))
+            return false;
+        tb_script_patch_chain(comp, blk->end_chain, program->nbr_instrs);
+        comp->nbr_blks--;
+    }
+    else if (strcmp(keyword, "CALL") == 0)
+    {
+        if (!tb_script_next_token(comp, &p, token, &is_quoted))
+            return false;
+        if (is_quoted || token[0] == '\0')
+            return tb_script_error(comp, "Missing procedure name");
+        // Resolved at the end, as the procedure may be defined further down
+        if (!tb_script_add_name(comp, token, TB_SCRIPT_NAME_PROC, &idx) ||
+            !tb_script_emit(comp, TB_SCRIPT_OP_CALL, idx, TB_SCRIPT_NO_INSTR, 0))
+            return false;
+    }
+    else if (strcmp(keyword, "RETURN") == 0)
+    {
+        if (!tb_script_emit(comp, tb_script_is_in_proc(comp) ? TB_SCRIPT_OP_RETURN : TB_SCRIPT_OP_END, 0, 0, 0))
+            return false;
+    }
+    else
+        return tb_script_error(comp, "Unknown statement '%s'", keyword);
+
+    if (!tb_script_is_end_of_line(p))
+        return tb_script_error(comp, "Unexpected text after the statement");
+    return true;
+}
+
+static bool tb_script_compile_text(tb_script_compiler_t *comp, const char *text)
+{
+    tb_script_program_t *program = comp->program;
+    const char *p = text;
+    uint32_t i;
+
+    // The checkpoint sequence is started over when the script starts, like TB_CHECKPOINT_SEQ before TB_BEGIN
+    comp->line = 1;
+    if (!tb_script_emit(comp, TB_SCRIPT_OP_CHECKPOINT_SEQ, 0, 0, 0))
+        return false;
+
+    for (comp->line = 1; *p != '\0'; comp->line++)
+    {
+        char keyword[TB_SCRIPT_MAX_TOKEN_LEN];
+        bool is_quoted;
+        bool is_ok = true;
+        const char *eol = strchr(p, '\n');
+        size_t len = eol ? (size_t)(eol - p) : strlen(p);
+        // Each line is parsed on its own copy, so that no statement can read into the next line
+        char *line_buf = malloc(len + 1);
+        const char *s = line_buf;
+
+        if (line_buf == NULL)
+            return tb_script_error(comp, "Out of memory");
+        memcpy(line_buf, p, len);
+        line_buf[len] = '\0';
+        if (!tb_script_is_end_of_line(s))
+        {
+            is_ok = tb_script_next_token(comp, &s, keyword, &is_quoted);
+            if (is_ok && is_quoted)
+                is_ok = tb_script_error(comp, "Expected a statement");
+            if (is_ok)
+                is_ok = tb_script_compile_stmt(comp, keyword, s);
+        }
+        free(line_buf);
+        if (!is_ok)
+            return false;
+        if (eol == NULL)
+            break;
+        p = eol + 1;
+    }
+
+    if (comp->nbr_blks > 0)
+    {
+        static const char *const blk_names[] = { "IF", "FOR", "WHILE", "PROC" };
+        comp->line = comp->blks[comp->nbr_blks - 1].line;
+        return tb_script_error(comp, "%s not ended", blk_names[comp->blks[comp->nbr_blks - 1].type]);
+    }
+    if (!tb_script_emit(comp, TB_SCRIPT_OP_END, 0, 0, 0))
+        return false;
+
+    for (i = 0; i < program->nbr_instrs; i++)
+    {
+        tb_script_instr_t *instr = &program->instrs[i];
+        if (instr->op != TB_SCRIPT_OP_CALL)
+            continue;
+        instr->b = comp->proc_addrs[instr->a];
+        if (instr->b == TB_SCRIPT_NO_INSTR)
+        {
+            comp->line = instr->line;
+            return tb_script_error(comp, "Undefined procedure %s", program->names[instr->a].str);
+        }
+    }
+    return true;
+}
+
+bool tb_script_compile(const char *text, const char *source, tb_script_program_t *program, char *err,
+    size_t err_size)
+{
+    tb_script_compiler_t comp;
+    bool is_ok;
+
+    memset(program, 0, sizeof(*program));
+    memset(&comp, 0, sizeof(comp));
+    comp.source = source;
+    comp.err = err;
+    comp.err_size = err_size;
+    comp.program = program;
+
+    program->source = tb_script_strdup(source);
+    if (program->source == NULL)
+        is_ok = tb_script_error(&comp, "Out of memory");
+    else
+        is_ok = tb_script_compile_text(&comp, text);
+    free(comp.proc_addrs);
+    if (!is_ok)
+        tb_script_program_free(program);
+    return is_ok;
+}
+
+// Compiled scripts: the magic and version, the counts, the source name, the names (kind, length, characters), the
+// instructions, and the checkpoints, all in the native byte order.
+
+static bool tb_script_write_str(FILE *file, const char *str)
+{
+    uint32_t len = strlen(str);
+    return fwrite(&len, sizeof(len), 1, file) == 1 && fwrite(str, 1, len, file) == len;
+}
+
+bool tb_script_write(const tb_script_program_t *program, const char *path)
+{
+    uint32_t header[6] = { TB_SCRIPT_VERSION, program->nbr_instrs, program->nbr_names, program->nbr_checkpoints,
+        program->nbr_loop_counters, 0 };
+    bool is_ok;
+    uint32_t i;
+    FILE *file = fopen(path, "wb");
+
+    if (file == NULL)
+        return false;
+    is_ok = fwrite(TB_SCRIPT_MAGIC, 1, strlen(TB_SCRIPT_MAGIC), file) == strlen(TB_SCRIPT_MAGIC) &&
+        fwrite(header, sizeof(header), 1, file) == 1 && tb_script_write_str(file, program->source);
+    for (i = 0; is_ok && i < program->nbr_names; i++)
+        is_ok = fwrite(&program->names[i].kind, 1, 1, file) == 1 && tb_script_write_str(file, program->names[i].str);
+    is_ok = is_ok &&
+        fwrite(program->instrs, sizeof(tb_script_instr_t), program->nbr_instrs, file) == program->nbr_instrs;
+    for (i = 0; is_ok && i < program->nbr_checkpoints; i++)
+        is_ok = fwrite(&program->checkpoints[i].time, sizeof(uint64_t), 1, file) == 1 &&
+            fwrite(&program->checkpoints[i].val, sizeof(int32_t), 1, file) == 1;
+    if (fclose(file) != 0)
+        is_ok = false;
+    return is_ok;
+}
+
+typedef struct
+{
+    const unsigned char *p;
+    const unsigned char *end;
+} tb_script_reader_t;
+
+static bool tb_script_read_bytes(tb_script_reader_t *reader, void *dst, size_t len)
+{
+    if ((size_t)(reader->end - reader->p) < len)
+        return false;
+    memcpy(dst, reader->p, len);
+    reader->p += len;
+    return true;
+}
+
+static bool tb_script_read_str(tb_script_reader_t *reader, char **str)
+{
+    uint32_t len;
+    if (!tb_script_read_bytes(reader, &len, sizeof(len)) || (size_t)(reader->end - reader->p) < len)
+        return false;
+    *str = malloc(len + 1);
+    if (*str == NULL)
+        return false;
+    memcpy(*str, reader->p, len);
+    (*str)[len] = '\0';
+    reader->p += len;
+    return true;
+}
+
+static bool tb_script_parse_binary(tb_script_reader_t *reader, tb_script_program_t *program)
+{
+    uint32_t header[6];
+    uint32_t i;
+
+    if (!tb_script_read_bytes(reader, header, sizeof(header)) || header[0] != TB_SCRIPT_VERSION)
+        return false;
+    if (!tb_script_read_str(reader, &program->source))
+        return false;
+    // The counts are checked against the file size before allocating, and the number of loop counters (allocated by
+    // the interpreter) against the number of instructions, as each loop has a FOR_INIT
+    if (header[1] == 0 || header[1] > (size_t)(reader->end - reader->p) / sizeof(tb_script_instr_t) ||
+        header[2] > (size_t)(reader->end - reader->p) || header[3] > (size_t)(reader->end - reader->p) ||
+        header[4] > header[1])
+        return false;
+    program->names = calloc(header[2] ? header[2] : 1, sizeof(tb_script_name_t));
+    program->instrs = malloc(header[1] * sizeof(tb_script_instr_t));
+    program->checkpoints = malloc((header[3] ? header[3] : 1) * sizeof(tb_script_checkpoint_t));
+    if (program->names == NULL || program->instrs == NULL || program->checkpoints == NULL)
+        return false;
+    for (i = 0; i < header[2]; i++, program->nbr_names++)
+        if (!tb_script_read_bytes(reader, &program->names[i].kind, 1) ||
+            !tb_script_read_str(reader, &program->names[i].str))
+            return false;
+    if (!tb_script_read_bytes(reader, program->instrs, header[1] * sizeof(tb_script_instr_t)))
+        return false;
+    program->nbr_instrs = header[1];
+    for (i = 0; i < header[3]; i++)
+        if (!tb_script_read_bytes(reader, &program->checkpoints[i].time, sizeof(uint64_t)) ||
+            !tb_script_read_bytes(reader, &program->checkpoints[i].val, sizeof(int32_t)))
+            return false;
+    program->nbr_checkpoints = header[3];
+    program->nbr_loop_counters = header[4];
+
+    // Validated once here, so that the interpreter needs no checks per instruction
+    for (i = 0; i < program->nbr_instrs; i++)
+    {
+        const tb_script_instr_t *instr = &program->instrs[i];
+        if (instr->op >= TB_SCRIPT_NBR_OPS)
+            return false;
+        switch (instr->op)
+        {
+        case TB_SCRIPT_OP_WAIT_COND:
+        case TB_SCRIPT_OP_ASSERT:
+            if (instr->a >= program->nbr_names || program->names[instr->a].kind != TB_SCRIPT_NAME_PRED)
+                return false;
+            break;
+        case TB_SCRIPT_OP_JUMP_IF_NOT:
+            if (instr->a >= program->nbr_names || program->names[instr->a].kind != TB_SCRIPT_NAME_PRED ||
+                instr->b >= program->nbr_instrs)
+                return false;
+            break;
+        case TB_SCRIPT_OP_DO:
+            if (instr->a >= program->nbr_names || program->names[instr->a].kind != TB_SCRIPT_NAME_ACTION)
+                return false;
+            break;
+        case TB_SCRIPT_OP_TEST_STEP:
+            if (instr->a >= program->nbr_names || program->names[instr->a].kind != TB_SCRIPT_NAME_TEXT)
+                return false;
+            break;
+        case TB_SCRIPT_OP_FOR_INIT:
+            if (instr->a >= program->nbr_loop_counters)
+                return false;
+            break;
+        case TB_SCRIPT_OP_FOR_TEST:
+        case TB_SCRIPT_OP_FOR_NEXT:
+            if (instr->a >= program->nbr_loop_counters || instr->b >= program->nbr_instrs)
+                return false;
+            break;
+        case TB_SCRIPT_OP_JUMP:
+        case TB_SCRIPT_OP_LOOP:
+        case TB_SCRIPT_OP_CALL:
+            if (instr->b >= program->nbr_instrs)
+                return false;
+            break;
+        default:
+            break;
+        }
+    }
+    return program->instrs[0].op == TB_SCRIPT_OP_CHECKPOINT_SEQ &&
+        program->instrs[program->nbr_instrs - 1].op == TB_SCRIPT_OP_END;
+}
+
+bool tb_script_read(const char *path, tb_script_program_t *program, char *err, size_t err_size)
+{
+    FILE *file = fopen(path, "rb");
+    char *contents;
+    long size;
+    bool is_ok;
+
+    memset(program, 0, sizeof(*program));
+    if (file == NULL)
+    {
+        snprintf(err, err_size, "%s: Cannot open file", path);
+        return false;
+    }
+    if (fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) < 0 || fseek(file, 0, SEEK_SET) != 0 ||
+        (contents = malloc(size + 1)) == NULL)
+    {
+        fclose(file);
+        snprintf(err, err_size, "%s: Cannot read file", path);
+        return false;
+    }
+    is_ok = fread(contents, 1, size, file) == (size_t)size;
+    fclose(file);
+    if (!is_ok)
+    {
+        free(contents);
+        snprintf(err, err_size, "%s: Cannot read file", path);
+        return false;
+    }
+    contents[size] = '\0';
+
+    if ((size_t)size >= strlen(TB_SCRIPT_MAGIC) && memcmp(contents, TB_SCRIPT_MAGIC, strlen(TB_SCRIPT_MAGIC)) == 0)
+    {
+        tb_script_reader_t reader = { (unsigned char *)contents + strlen(TB_SCRIPT_MAGIC),
+            (unsigned char *)contents + size };
+        is_ok = tb_script_parse_binary(&reader, program);
+        if (!is_ok)
+        {
+            tb_script_program_free(program);
+            snprintf(err, err_size, "%s: Invalid or incompatible compiled script", path);
+        }
+    }
+    else if (memchr(contents, '\0', size) != NULL)
+    {
+        is_ok = false;
+        snprintf(err, err_size, "%s: Neither a script nor a compiled script", path);
+    }
+    else
+        is_ok = tb_script_compile(contents, path, program, err, err_size);
+    free(contents);
+    return is_ok;
+}
+
+void tb_script_program_free(tb_script_program_t *program)
+{
+    uint32_t i;
+    for (i = 0; i < program->nbr_names; i++)
+        free(program->names[i].str);
+    free(program->names);
+    free(program->instrs);
+    free(program->checkpoints);
+    free(program->source);
+    memset(program, 0, sizeof(*program));
+}
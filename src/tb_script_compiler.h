@@ -0,0 +1,115 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef TB_SCRIPT_COMPILER_H
+#define TB_SCRIPT_COMPILER_H
+
+// This file contains the bytecode of the test sequence scripts run by tb_script.h, and the compiler of the script text
+// syntax into it. It does not depend on BabbleSim, so the tb_script_compile tool also uses it.
+//
+// Script text syntax: one statement per line, mirroring the tb_defs.h macros; "#" starts a comment. Times and delays
+// are in microseconds, and may be written like in C, e.g. 11.5e6. Predicates and actions are the names of C functions
+// bound by the test bench (see tb_script.h); a predicate may be negated with "!".
+//
+//   CHECKPOINT_SEQ {<time>,<value>} ...     Checkpoint sequence of the script (may be split over several lines)
+//   TEST_STEP "<text>"
+//   WAIT <delay>
+//   WAIT_UNTIL <time>
+//   WAIT_COND [!]<predicate> [<deadline delay>]
+//   CHECKPOINT <value>
+//   ASSERT [!]<predicate>
+//   DO <action>
+//   IF [!]<predicate> / ELSIF [!]<predicate> / ELSE / ENDIF
+//   FOR <count> / ENDFOR
+//   WHILE [!]<predicate> / ENDWHILE
+//   BREAK / CONTINUE
+//   PROC <name> / ENDPROC                   Procedure (at top level only), called with CALL <name>
+//   CALL <name>
+//   RETURN
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum
+{
+    TB_SCRIPT_OP_CHECKPOINT_SEQ,    // Starts the checkpoint sequence of the script (if any) over; always first
+    TB_SCRIPT_OP_WAIT,              // t: delay
+    TB_SCRIPT_OP_WAIT_UNTIL,        // t: time
+    TB_SCRIPT_OP_WAIT_COND,         // a: predicate, t: deadline delay (TB_SCRIPT_NO_DEADLINE if none)
+    TB_SCRIPT_OP_JUMP,              // b: target
+    TB_SCRIPT_OP_JUMP_IF_NOT,       // a: predicate, b: target
+    TB_SCRIPT_OP_FOR_INIT,          // a: loop counter
+    TB_SCRIPT_OP_FOR_TEST,          // a: loop counter, t: count, b: target when done
+    TB_SCRIPT_OP_FOR_NEXT,          // a: loop counter, b: FOR_TEST; iterates via a zero delay tick like TB_ENDFOR
+    TB_SCRIPT_OP_LOOP,              // b: loop condition; iterates via a zero delay tick like TB_ENDWHILE
+    TB_SCRIPT_OP_CALL,              // a: procedure name, b: procedure
+    TB_SCRIPT_OP_RETURN,
+    TB_SCRIPT_OP_END,
+    TB_SCRIPT_OP_CHECKPOINT,        // t: value (int32_t)
+    TB_SCRIPT_OP_TEST_STEP,         // a: text
+    TB_SCRIPT_OP_DO,                // a: action
+    TB_SCRIPT_OP_ASSERT,            // a: predicate
+    TB_SCRIPT_NBR_OPS
+} tb_script_op_t;
+
+#define TB_SCRIPT_NO_DEADLINE UINT64_MAX
+
+typedef struct
+{
+    uint8_t op;
+    uint8_t is_negated;             // The predicate is negated
+    uint16_t reserved;
+    uint32_t line;                  // Source line, for error messages
+    uint32_t a;                     // Name index or loop counter
+    uint32_t b;                     // Jump target
+    uint64_t t;                     // Time, delay, count, or checkpoint value
+} tb_script_instr_t;
+
+typedef enum
+{
+    TB_SCRIPT_NAME_PRED,
+    TB_SCRIPT_NAME_ACTION,
+    TB_SCRIPT_NAME_TEXT,
+    TB_SCRIPT_NAME_PROC,
+} tb_script_name_kind_t;
+
+typedef struct
+{
+    char *str;
+    uint8_t kind;                   // tb_script_name_kind_t
+} tb_script_name_t;
+
+typedef struct
+{
+    uint64_t time;
+    int32_t val;
+} tb_script_checkpoint_t;
+
+typedef struct
+{
+    char *source;                   // Name of the script source file
+    tb_script_instr_t *instrs;
+    uint32_t nbr_instrs;
+    tb_script_name_t *names;
+    uint32_t nbr_names;
+    tb_script_checkpoint_t *checkpoints;
+    uint32_t nbr_checkpoints;
+    uint32_t nbr_loop_counters;
+} tb_script_program_t;
+
+// Compiles the script text. On error, returns false with a "<source>:<line>: <message>" error message.
+bool tb_script_compile(const char *text, const char *source, tb_script_program_t *program, char *err,
+    size_t err_size);
+
+// Reads a script file, either compiled (as written by tb_script_write) or as text, which is then compiled.
+bool tb_script_read(const char *path, tb_script_program_t *program, char *err, size_t err_size);
+
+// Writes the compiled script, in the native byte order
+bool tb_script_write(const tb_script_program_t *program, const char *path);
+
+void tb_script_program_free(tb_script_program_t *program);
+
+#endif // #ifndef TB_SCRIPT_COMPILER_H
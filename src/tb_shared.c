@@ -0,0 +1,219 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// This file contains the shared variable table (see tb_shared.h).
+
+// For mmap() and friends, as the library is otherwise built as C99
+#define _DEFAULT_SOURCE
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef TB_DEFS_ENV_HEADER
+// Alternative environment providing the BabbleSim API used below (e.g. the stand-ins used by the unit tests)
+#include TB_DEFS_ENV_HEADER
+#else
+#include "bs_types.h"
+#include "bs_tracing.h"
+// Provided by the device the test bench is linked with (normally declared in time_machine.h)
+bs_time_t tm_get_hw_time(void);
+#endif
+
+#include "tb_shared.h"
+
+#define TB_SHARED_MAGIC 0x48534254 // "TBSH"
+
+#define TB_SHARED_VAR_FREE 0
+#define TB_SHARED_VAR_NAMING 1
+#define TB_SHARED_VAR_NAMED 2
+
+#define TB_SHARED_NBR_WORDS (TB_SHARED_VALUE_SIZE / sizeof(uint64_t))
+
+struct tb_shared_table_s
+{
+    // Set by the first process opening the (zero filled) table; checked by the others
+    struct
+    {
+        uint32_t magic;
+        uint32_t nbr_vars;
+    } __attribute__ ((__aligned__ (64))) header;
+    tb_shared_var_t vars[TB_SHARED_MAX_VARS];
+};
+
+// The header fields are set with compare-and-swap, so that processes opening the table at the same time agree
+static bool tb_shared_check_header_field(uint32_t *field, uint32_t val)
+{
+    uint32_t expected = 0;
+    return __atomic_compare_exchange_n(field, &expected, val, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) ||
+        expected == val;
+}
+
+tb_shared_t *tb_shared_open(const char *path, const char *print_prefix)
+{
+    tb_shared_t *shared = calloc(1, sizeof(tb_shared_t));
+    void *table;
+
+    if (shared == NULL)
+    {
+        tb_assert_failed(__FILE__, __LINE__, "%sTB_ASSERT failed: Out of memory for shared variable table\n",
+            print_prefix);
+        return NULL;
+    }
+    shared->size = sizeof(struct tb_shared_table_s);
+    if (path == NULL)
+        // Anonymous, but shared, so that child processes share it too
+        table = mmap(NULL, shared->size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    else
+    {
+        struct stat file_stat;
+        int fd = open(path, O_RDWR | O_CREAT, 0600);
+        table = MAP_FAILED;
+        if (fd >= 0)
+        {
+            // A new file is zero filled up to the size, i.e. all variables free
+            if (fstat(fd, &file_stat) == 0 &&
+                (file_stat.st_size >= (off_t)shared->size || ftruncate(fd, shared->size) == 0))
+                table = mmap(NULL, shared->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+        }
+    }
+    if (table == MAP_FAILED)
+    {
+        free(shared);
+        tb_assert_failed(__FILE__, __LINE__, "%sTB_ASSERT failed: Cannot map shared variable table %s\n",
+            print_prefix, path ? path : "(anonymous)");
+        return NULL;
+    }
+    shared->table = table;
+    if (!tb_shared_check_header_field(&shared->table->header.magic, TB_SHARED_MAGIC) ||
+        !tb_shared_check_header_field(&shared->table->header.nbr_vars, TB_SHARED_MAX_VARS))
+    {
+        tb_shared_close(shared);
+        tb_assert_failed(__FILE__, __LINE__, "%sTB_ASSERT failed: %s is not a compatible shared variable table\n",
+            print_prefix, path ? path : "(anonymous)");
+        return NULL;
+    }
+    return shared;
+}
+
+void tb_shared_close(tb_shared_t *shared)
+{
+    if (shared == NULL)
+        return;
+    munmap(shared->table, shared->size);
+    free(shared);
+}
+
+// Variables are found by open addressing from the hash of the name. A process adding a variable claims a free entry
+// before naming it, so concurrent additions of the same or different names by several processes cannot clash.
+tb_shared_var_t *tb_shared_var(tb_shared_t *shared, const char *name, const char *print_prefix, const char *file,
+    unsigned int line)
+{
+    size_t len = strlen(name);
+    unsigned int idx;
+    unsigned int i;
+
+    if (len >= TB_SHARED_NAME_SIZE)
+    {
+        tb_assert_failed(file, line, "%sTB_ASSERT failed: Shared variable name %s too long\n", print_prefix, name);
+        return NULL;
+    }
+    idx = tb_hash(name, len) % TB_SHARED_MAX_VARS;
+    for (i = 0; i < TB_SHARED_MAX_VARS; i++, idx = (idx + 1) % TB_SHARED_MAX_VARS)
+    {
+        tb_shared_var_t *var = &shared->table->vars[idx];
+        uint32_t state = __atomic_load_n(&var->state, __ATOMIC_ACQUIRE);
+        if (state == TB_SHARED_VAR_FREE &&
+            __atomic_compare_exchange_n(&var->state, &state, TB_SHARED_VAR_NAMING, false, __ATOMIC_ACQ_REL,
+                __ATOMIC_ACQUIRE))
+        {
+            memcpy(var->name, name, len + 1);
+            __atomic_store_n(&var->state, TB_SHARED_VAR_NAMED, __ATOMIC_RELEASE);
+            return var;
+        }
+        // Being named by another process
+        while (state == TB_SHARED_VAR_NAMING)
+            state = __atomic_load_n(&var->state, __ATOMIC_ACQUIRE);
+        if (strcmp(var->name, name) == 0)
+            return var;
+    }
+    tb_assert_failed(file, line, "%sTB_ASSERT failed: More than %d shared variables\n", print_prefix,
+        TB_SHARED_MAX_VARS);
+    return NULL;
+}
+
+void tb_shared_write(tb_shared_var_t *var, const void *data, size_t len, const char *print_prefix, const char *file,
+    unsigned int line)
+{
+    uint64_t words[TB_SHARED_NBR_WORDS] = { 0 };
+    uint32_t seq;
+    unsigned int i;
+
+    if (len > TB_SHARED_VALUE_SIZE)
+    {
+        tb_assert_failed(file, line, "%sTB_ASSERT failed: Shared variable value of %u bytes too large\n",
+            print_prefix, (unsigned int)len);
+        return;
+    }
+    memcpy(words, data, len);
+    // Writers (in any process) exclude each other by making the sequence odd
+    do
+        seq = __atomic_load_n(&var->seq, __ATOMIC_RELAXED);
+    while ((seq & 1) || !__atomic_compare_exchange_n(&var->seq, &seq, seq + 1, false, __ATOMIC_ACQUIRE,
+        __ATOMIC_RELAXED));
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for (i = 0; i < TB_SHARED_NBR_WORDS; i++)
+        __atomic_store_n(&var->value[i], words[i], __ATOMIC_RELAXED);
+    __atomic_store_n(&var->time, tm_get_hw_time(), __ATOMIC_RELAXED);
+    __atomic_store_n(&var->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+// Retried until no write overlapped the read, i.e. the sequence was even and unchanged
+static bs_time_t tb_shared_read_words(const tb_shared_var_t *var, uint64_t *words)
+{
+    uint32_t seq;
+    bs_time_t time;
+    unsigned int i;
+    do
+    {
+        seq = __atomic_load_n(&var->seq, __ATOMIC_ACQUIRE);
+        for (i = 0; i < TB_SHARED_NBR_WORDS; i++)
+            words[i] = __atomic_load_n(&var->value[i], __ATOMIC_RELAXED);
+        time = __atomic_load_n(&var->time, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((seq & 1) || __atomic_load_n(&var->seq, __ATOMIC_RELAXED) != seq);
+    return time;
+}
+
+bs_time_t tb_shared_read(const tb_shared_var_t *var, void *data, size_t len, const char *print_prefix,
+    const char *file, unsigned int line)
+{
+    uint64_t words[TB_SHARED_NBR_WORDS];
+    bs_time_t time;
+
+    if (len > TB_SHARED_VALUE_SIZE)
+    {
+        tb_assert_failed(file, line, "%sTB_ASSERT failed: Shared variable value of %u bytes too large\n",
+            print_prefix, (unsigned int)len);
+        return 0;
+    }
+    time = tb_shared_read_words(var, words);
+    memcpy(data, words, len);
+    return time;
+}
+
+int64_t tb_shared_get(const tb_shared_var_t *var)
+{
+    uint64_t words[TB_SHARED_NBR_WORDS];
+    int64_t val;
+    tb_shared_read_words(var, words);
+    memcpy(&val, words, sizeof(val));
+    return val;
+}
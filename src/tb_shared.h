@@ -0,0 +1,98 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef TB_SHARED_H
+#define TB_SHARED_H
+
+// This file provides a table of named variables in shared memory, through which the test benches of devices running
+// in separate processes (as in a BabbleSim simulation) can coordinate, e.g. device B waiting until device A has reached
+// some phase, without relaying the state through simulated radio traffic. A variable is read lock-free (seqlock), so a
+// read costs about a cache line read, and can be used in test sequence conditions.
+//
+// All devices open the table with the same path, which should be unique per simulation (e.g. contain the simulation
+// id); the file is created if it does not exist, and should be removed when the simulation is over. With a NULL path,
+// an anonymous table is created instead, shared only by the process and its children, e.g. for test benches running
+// without the simulator.
+//
+// Example: Device A: static tb_shared_t *shared; static tb_shared_var_t *phase;
+//                    In the initialization: shared = TB_SHARED_OPEN(path); phase = TB_SHARED_VAR(shared, "phase");
+//                    In the test sequence: TB_SHARED_SET(phase, 2);
+//          Device B: TB_WAIT_COND_POLL(TB_SHARED_GET(phase) >= 2, 10, 1e3, TIME_NEVER);
+//
+// No event is signalled when another process writes a variable, so wait for variables with TB_WAIT_COND_POLL. The
+// devices of a simulation are only loosely synchronized in wall-clock time, so a variable can be read before or after
+// the device writing it has reached the simulated time of the write; use variables whose order of updates is
+// otherwise given (e.g. phases or counters that only increase), or check the simulated write time (see TB_SHARED_READ).
+
+#include "tb_defs.h"
+
+#define TB_SHARED_MAX_VARS 64           // Number of variables of a table
+#define TB_SHARED_NAME_SIZE 24          // Including the terminating NUL
+#define TB_SHARED_VALUE_SIZE 24         // Max size of the value of a variable
+
+// Variable, in its own cache line
+typedef struct
+{
+    uint32_t state;                     // Free, being named, or named
+    uint32_t seq;                       // Incremented before and after each write, so odd while being written
+    char name[TB_SHARED_NAME_SIZE];
+    uint64_t time;                      // Simulated time of the last write
+    uint64_t value[TB_SHARED_VALUE_SIZE / sizeof(uint64_t)];
+} __attribute__ ((__aligned__ (64))) tb_shared_var_t;
+
+typedef struct
+{
+    struct tb_shared_table_s *table;    // Mapped table
+    size_t size;
+} tb_shared_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+tb_shared_t *tb_shared_open(const char *path, const char *print_prefix);
+void tb_shared_close(tb_shared_t *shared);
+tb_shared_var_t *tb_shared_var(tb_shared_t *shared, const char *name, const char *print_prefix, const char *file,
+    unsigned int line);
+void tb_shared_write(tb_shared_var_t *var, const void *data, size_t len, const char *print_prefix, const char *file,
+    unsigned int line);
+bs_time_t tb_shared_read(const tb_shared_var_t *var, void *data, size_t len, const char *print_prefix,
+    const char *file, unsigned int line);
+int64_t tb_shared_get(const tb_shared_var_t *var);
+#ifdef __cplusplus
+}
+#endif
+
+// TB_SHARED_OPEN opens (and creates if needed) the shared variable table with the specified path, or creates an
+// anonymous table if the path is NULL, and evaluates to it. The test fails if the table cannot be opened.
+#define TB_SHARED_OPEN(_path) \
+    tb_shared_open(_path, TB_PRINT_PREFIX)
+
+// TB_SHARED_VAR evaluates to the variable with the specified name in the specified table, which is added if it does not
+// exist yet (with value 0 and write time 0). Look the variable up once, e.g. at initialization, and keep the pointer.
+#define TB_SHARED_VAR(_shared, _name) \
+    tb_shared_var(_shared, _name, TB_PRINT_PREFIX, __FILE__, __LINE__)
+
+// TB_SHARED_SET sets the specified variable to the specified integer value.
+#define TB_SHARED_SET(_var, _val) \
+    { \
+        int64_t tb_shared_val = (_val); \
+        tb_shared_write(_var, &tb_shared_val, sizeof(tb_shared_val), TB_PRINT_PREFIX, __FILE__, __LINE__); \
+    }
+
+// TB_SHARED_GET evaluates to the integer value of the specified variable.
+#define TB_SHARED_GET(_var) \
+    tb_shared_get(_var)
+
+// TB_SHARED_WRITE sets the specified variable to the contents of the specified buffer (at most TB_SHARED_VALUE_SIZE
+// bytes), e.g. a struct. The variable is never read partially written.
+#define TB_SHARED_WRITE(_var, _ptr, _len) \
+    tb_shared_write(_var, _ptr, _len, TB_PRINT_PREFIX, __FILE__, __LINE__);
+
+// TB_SHARED_READ copies the value of the specified variable into the specified buffer, and evaluates to the simulated
+// time at which the value was written.
+#define TB_SHARED_READ(_var, _ptr, _len) \
+    tb_shared_read(_var, _ptr, _len, TB_PRINT_PREFIX, __FILE__, __LINE__)
+
+#endif // #ifndef TB_SHARED_H
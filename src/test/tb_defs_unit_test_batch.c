@@ -0,0 +1,133 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// The purpose of this test bench is to test batches: many instances of one test sequence, run from one device tick
+// handler, must each advance independently (through waits, loops, sub-test sequences, signalled conditions, and a
+// barrier between the instances), only due instances must be stepped, and the instances due at the same time must be
+// stepped grouped by resume point.
+
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Batch test: "
+
+#define NBR_INSTANCES 100
+#define LAST_INSTANCE 98 // Last instance to arrive at the barrier: the highest one receiving only the second rx
+
+void device_tick(bs_time_t HW_device_time);
+
+static tb_batch_t batch;
+static tb_barrier_t all_done = TB_BARRIER_INIT(NBR_INSTANCES);
+static unsigned int nbr_device_ticks;
+static unsigned int nbr_entries[NBR_INSTANCES];
+static unsigned int nbr_rx[NBR_INSTANCES];
+static unsigned int loop_idx[NBR_INSTANCES];
+static bs_time_t rx_times[NBR_INSTANCES];
+static bs_time_t done_times[NBR_INSTANCES];
+static unsigned int step_order[NBR_INSTANCES];
+static unsigned int nbr_steps_at_1e3;
+
+void device_tick(bs_time_t HW_device_time)
+{
+    nbr_device_ticks++;
+    TB_BATCH_DISPATCH(batch);
+}
+
+// Received by every third instance
+static void first_rx_handler(void)
+{
+    for (unsigned int i = 0; i < NBR_INSTANCES; i += 3)
+    {
+        nbr_rx[i]++;
+        TB_BATCH_SIGNAL_EVENT(batch, i);
+    }
+}
+
+// Received by all instances
+static void second_rx_handler(void)
+{
+    for (unsigned int i = 0; i < NBR_INSTANCES; i++)
+    {
+        nbr_rx[i]++;
+        TB_BATCH_SIGNAL_EVENT(batch, i);
+    }
+}
+
+void wait_instance_delay(TB_CONTEXT_PARAM)
+{
+    TB_BEGIN
+    TB_WAIT(TB_INSTANCE);
+    TB_WAIT(100);
+    TB_END
+}
+
+void device_seq(TB_CONTEXT_PARAM)
+{
+    nbr_entries[TB_INSTANCE]++;
+
+    TB_BEGIN
+    // Odd and even instances wait at different resume points
+    TB_IF(TB_INSTANCE % 2 == 1)
+        TB_WAIT(1e3);
+    TB_ELSE
+        TB_WAIT_UNTIL(1e3);
+    TB_ENDIF
+    step_order[nbr_steps_at_1e3++] = TB_INSTANCE;
+
+    TB_FOR(loop_idx[TB_INSTANCE] = 0, loop_idx[TB_INSTANCE] < 3, loop_idx[TB_INSTANCE]++)
+        TB_WAIT(100);
+    TB_ENDFOR
+
+    TB_WAIT_COND(nbr_rx[TB_INSTANCE] > 0);
+    rx_times[TB_INSTANCE] = tm_get_hw_time();
+
+    TB_CALL(wait_instance_delay);
+    TB_BARRIER_WAIT(all_done);
+    done_times[TB_INSTANCE] = tm_get_hw_time();
+    TB_END
+}
+
+int main()
+{
+    TB_TEST_STEP("Batch of %d instances", NBR_INSTANCES);
+    TB_BATCH_INIT(batch, NBR_INSTANCES, device_seq, NULL, device_tick);
+    bst_ticker_set_next_tick_absolute(0);
+    tb_defs_unit_test_schedule_special_event_delta(2e3, first_rx_handler);
+    tb_defs_unit_test_schedule_special_event_delta(3e3, second_rx_handler);
+    tb_defs_unit_test_scheduler(device_tick);
+
+    TB_TEST_STEP("Instances stepped grouped by resume point");
+    TB_ASSERT(nbr_steps_at_1e3 == NBR_INSTANCES, "%u instances stepped at 1e3", nbr_steps_at_1e3);
+    for (unsigned int k = 0; k < NBR_INSTANCES; k++)
+        TB_ASSERT(step_order[k] == (k < NBR_INSTANCES / 2 ? 2 * k + 1 : 2 * (k - NBR_INSTANCES / 2)),
+            "Instance %u stepped as number %u at 1e3", step_order[k], k);
+
+    TB_TEST_STEP("Instances advanced independently");
+    for (unsigned int i = 0; i < NBR_INSTANCES; i++)
+    {
+        bs_time_t rx_time = i % 3 == 0 ? 2e3 : 3e3;
+        TB_ASSERT(rx_times[i] == rx_time, "Instance %u received at %u", i, (unsigned int)rx_times[i]);
+        // Released by the last instance to arrive at the barrier
+        TB_ASSERT(done_times[i] == 3.1e3 + LAST_INSTANCE, "Instance %u done at %u", i,
+            (unsigned int)done_times[i]);
+        // Start, 1e3, the 3 loop iterations (each also entering at the end of the loop body), the rx, the two waits of
+        // the sub-test sequence, and the barrier, which the last instance to arrive passes without waiting. The
+        // instances receiving the first rx are also entered at the second one, while waiting at the barrier.
+        TB_ASSERT(nbr_entries[i] == 12 + (i % 3 == 0) - (i == LAST_INSTANCE), "Instance %u entered %u times", i,
+            nbr_entries[i]);
+        TB_ASSERT(TB_BATCH_CONTEXT(batch, i)->is_func_done, "Instance %u not done", i);
+    }
+
+    TB_TEST_STEP("Only due instances stepped");
+    // One device tick at each distinct tick time: 0, 1e3, 1.1e3, 1.2e3, 1.3e3, the first rx (2e3), the ends of the two
+    // waits of the sub-test sequence of the 34 instances receiving it (2e3 + i, of which 2e3 + 0 is the rx time itself,
+    // and 2.1e3 + i), the second rx (3e3), and the same for the other 66 instances (3e3 + i and 3.1e3 + i)
+    TB_ASSERT(nbr_device_ticks == 5 + 1 + 33 + 34 + 1 + 66 + 66, "%u device ticks", nbr_device_ticks);
+    TB_BATCH_FREE(batch);
+
+    TB_TEST_STEP("Test ended - all OK!");
+    return 0;
+}
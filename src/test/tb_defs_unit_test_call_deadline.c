@@ -0,0 +1,183 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// The purpose of this test bench is to test TB_CALL_W_DEADLINE: a sub-test sequence completing before its deadline,
+// hung (nested) sub-test sequences being aborted and starting over when called again, nested deadlines, an aborted
+// wait for a synchronization object, sub-test sequences nested deeper than TB_MAX_CALL_DEPTH, and no tick of an aborted
+// sub-test sequence remaining after the abort.
+
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Call deadline test: "
+
+TB_GLOBALS
+
+void test_tick(bs_time_t HW_device_time);
+
+static tb_sem_t sem = TB_SEM_INIT(0);
+static bool is_event;
+static unsigned int nbr_starts;
+static unsigned int nbr_outer_starts;
+static unsigned int nbr_inner_starts;
+static unsigned int nbr_deepest_starts;
+
+void sem_give_handler(void)
+{
+    TB_SEM_GIVE(sem);
+}
+
+void quick_sub(TB_CONTEXT_PARAM)
+{
+    TB_BEGIN
+    TB_WAIT(1e3);
+    TB_END
+}
+
+void hung_inner(TB_CONTEXT_PARAM)
+{
+    TB_BEGIN
+    nbr_inner_starts++;
+    TB_WAIT(1e3);
+    TB_WAIT_COND(is_event);
+    TB_END
+}
+
+void hung_outer(TB_CONTEXT_PARAM)
+{
+    TB_BEGIN
+    nbr_outer_starts++;
+    TB_CALL(hung_inner);
+    TB_WAIT(1e3);
+    TB_END
+}
+
+void mid_sub(TB_CONTEXT_PARAM, bs_time_t inner_delay)
+{
+    TB_BEGIN
+    TB_CALL_W_DEADLINE_DELTA(inner_delay, hung_inner);
+    TB_ASSERT(TB_CALL_TIMED_OUT, "Inner sub-test sequence did not time out");
+    TB_WAIT(1e3);
+    TB_END
+}
+
+void sem_sub(TB_CONTEXT_PARAM)
+{
+    TB_BEGIN
+    TB_SEM_TAKE(sem);
+    TB_END
+}
+
+void long_wait_sub(TB_CONTEXT_PARAM)
+{
+    TB_BEGIN
+    TB_WAIT(1e6);
+    TB_END
+}
+
+// A chain of sub-test sequences, the deepest one called at call depth TB_MAX_CALL_DEPTH + 4
+void nested_sub_19(TB_CONTEXT_PARAM)
+{
+    TB_BEGIN
+    nbr_deepest_starts++;
+    TB_WAIT(1e3);
+    TB_END
+}
+
+#define NESTED_SUB(_n, _next) \
+    void nested_sub_##_n(TB_CONTEXT_PARAM) \
+    { \
+        TB_BEGIN \
+        TB_CALL(nested_sub_##_next); \
+        TB_END \
+    }
+
+NESTED_SUB(18, 19) NESTED_SUB(17, 18) NESTED_SUB(16, 17) NESTED_SUB(15, 16) NESTED_SUB(14, 15) NESTED_SUB(13, 14)
+NESTED_SUB(12, 13) NESTED_SUB(11, 12) NESTED_SUB(10, 11) NESTED_SUB(9, 10) NESTED_SUB(8, 9) NESTED_SUB(7, 8)
+NESTED_SUB(6, 7) NESTED_SUB(5, 6) NESTED_SUB(4, 5) NESTED_SUB(3, 4) NESTED_SUB(2, 3) NESTED_SUB(1, 2) NESTED_SUB(0, 1)
+
+void test_tick(bs_time_t HW_device_time)
+{
+    TB_CHECKPOINT_SEQ(
+        {1e3,1}, {21e3,2}, {26e3,3}, {28e3,4}, {31e3,5}, {33e3,6}, {53e3,7}, {54e3,8}, {56e3,9},
+        {56.5e3,10}, {57.5e3,11}, {58.5e3,12}, {58.5e3,-1}
+    );
+    TB_TICK_HANDLER(test_tick);
+
+    TB_BEGIN
+    nbr_starts++;
+
+    TB_TEST_STEP("Completes before deadline");
+    TB_CALL_W_DEADLINE_DELTA(10e3, quick_sub);
+    TB_CHECKPOINT(1);
+    TB_ASSERT(!TB_CALL_TIMED_OUT, "Timed out");
+    // The deadline must not end the wait early
+    TB_WAIT(20e3);
+    TB_CHECKPOINT(2);
+
+    TB_TEST_STEP("Hung nested sub-test sequences");
+    is_event = false;
+    TB_CALL_W_DEADLINE(26e3, hung_outer);
+    TB_CHECKPOINT(3);
+    TB_ASSERT(TB_CALL_TIMED_OUT, "Did not time out");
+    // Called again, both sub-test sequences start over
+    is_event = true;
+    TB_CALL_W_DEADLINE_DELTA(10e3, hung_outer);
+    TB_CHECKPOINT(4);
+    TB_ASSERT(!TB_CALL_TIMED_OUT, "Timed out");
+    TB_ASSERT(nbr_outer_starts == 2 && nbr_inner_starts == 2, "Started %u and %u times", nbr_outer_starts,
+        nbr_inner_starts);
+
+    TB_TEST_STEP("Nested deadlines");
+    is_event = false;
+    // The inner deadline comes first
+    TB_CALL_W_DEADLINE_DELTA(10e3, mid_sub, 2e3);
+    TB_CHECKPOINT(5);
+    TB_ASSERT(!TB_CALL_TIMED_OUT, "Timed out");
+    // The outer deadline comes first; the inner deadline must not end the following wait early
+    TB_CALL_W_DEADLINE_DELTA(2e3, mid_sub, 10e3);
+    TB_CHECKPOINT(6);
+    TB_ASSERT(TB_CALL_TIMED_OUT, "Did not time out");
+    TB_WAIT(20e3);
+    TB_CHECKPOINT(7);
+
+    TB_TEST_STEP("Aborted wait for a synchronization object");
+    TB_CALL_W_DEADLINE_DELTA(1e3, sem_sub);
+    TB_CHECKPOINT(8);
+    TB_ASSERT(TB_CALL_TIMED_OUT, "Did not time out");
+    // The semaphore must not be given to the aborted sub-test sequence
+    tb_defs_unit_test_schedule_special_event_delta(1e3, sem_give_handler);
+    TB_WAIT(2e3);
+    TB_SEM_TAKE(sem);
+    TB_CHECKPOINT(9);
+
+    TB_TEST_STEP("Nested deeper than TB_MAX_CALL_DEPTH");
+    TB_CALL_W_DEADLINE_DELTA(500, nested_sub_0);
+    TB_CHECKPOINT(10);
+    TB_ASSERT(TB_CALL_TIMED_OUT, "Did not time out");
+    // Called again, the whole chain starts over
+    TB_CALL(nested_sub_0);
+    TB_CHECKPOINT(11);
+    TB_ASSERT(nbr_deepest_starts == 2, "Deepest sub-test sequence started %u times", nbr_deepest_starts);
+
+    TB_TEST_STEP("Sequence ending after an abort");
+    TB_CALL_W_DEADLINE_DELTA(1e3, long_wait_sub);
+    TB_CHECKPOINT(12);
+    TB_ASSERT(TB_CALL_TIMED_OUT, "Did not time out");
+
+    TB_END
+}
+
+int main()
+{
+    bst_ticker_set_next_tick_absolute(0);
+    tb_defs_unit_test_scheduler(test_tick);
+    // The simulation must end at the abort: the tick of the aborted TB_WAIT must have been cancelled
+    TB_CHECKPOINT(-1);
+    TB_ASSERT(nbr_starts == 1, "Sequence started %u times", nbr_starts);
+    TB_TEST_STEP("Test ended - all OK!");
+    return 0;
+}
@@ -0,0 +1,149 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// The purpose of this test bench is to test deferred checkpoint verification (TB_DEFER_CHECKPOINTS): checkpoints
+// logged in a loop, more than fit in the log, must be verified when the log is full and at TB_END (or TB_RETURN), and
+// mismatches must be reported with the same messages as in immediate mode, at the first differing checkpoint.
+
+#define TB_DEFER_CHECKPOINTS true
+
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Checkpoint log test: "
+
+TB_GLOBALS
+
+#define NBR_LOOP_CHECKPOINTS (3 * TB_CHECKPOINT_LOG_SIZE + 10)
+
+static tb_checkpoint_t expected[NBR_LOOP_CHECKPOINTS];
+static int loop_idx;
+static int wrong_idx;           // Index of the checkpoint logged with a wrong value (-1 if none)
+static int nbr_logged;
+static int nbr_verified_in_loop;  // Before TB_END
+
+void loop_tick(bs_time_t HW_device_time)
+{
+    TB_BEGIN
+    TB_FOR(loop_idx = 0, loop_idx < nbr_logged, loop_idx++)
+        TB_CHECKPOINT(loop_idx == wrong_idx ? -1 : loop_idx);
+        TB_IF(loop_idx % 100 == 99)
+            TB_WAIT(10);
+        TB_ENDIF
+    TB_ENDFOR
+    nbr_verified_in_loop = tb_context_ptr->checkpoint_idx;
+    TB_END
+}
+
+void finish_tick(bs_time_t HW_device_time)
+{
+    TB_CHECKPOINT_SEQ(
+        {0,1}, {1e3,2}
+    );
+
+    TB_BEGIN
+    TB_CHECKPOINT(1);
+    TB_WAIT(1e3);
+    TB_CHECKPOINT(3);
+    TB_FINISH(true);
+    TB_WHILE(true)
+        TB_WAIT(1e3);
+    TB_ENDWHILE
+    TB_END
+}
+
+void return_tick(bs_time_t HW_device_time)
+{
+    TB_CHECKPOINT_SEQ(
+        {0,1}, {1e3,2}
+    );
+
+    TB_BEGIN
+    TB_CHECKPOINT(1);
+    TB_WAIT(1e3);
+    TB_CHECKPOINT(3);
+    TB_RETURN
+    TB_END
+}
+
+static void finish_hook(bool passed)
+{
+    tb_defs_unit_test_stop();
+}
+
+static void run_loop(int nbr, int wrong, int nbr_items, char *expected_error)
+{
+    tb_defs_unit_test_reset();
+    if (expected_error)
+        tb_defs_unit_test_expect_fatal_error(expected_error);
+    TB_RESET(tb_context_ptr);
+    tb_context_ptr->checkpoints = nbr_items ? expected : NULL;
+    tb_context_ptr->nbr_checkpoints = nbr_items;
+    nbr_logged = nbr;
+    wrong_idx = wrong;
+    bst_ticker_set_next_tick_absolute(0);
+    tb_defs_unit_test_scheduler(loop_tick);
+}
+
+int main()
+{
+    char expected_error[256];
+
+    for (int i = 0; i < NBR_LOOP_CHECKPOINTS; i++)
+    {
+        expected[i].time = i / 100 * 10;
+        expected[i].val = i;
+    }
+
+    TB_TEST_STEP("Checkpoints verified when the log is full and at TB_END");
+    run_loop(NBR_LOOP_CHECKPOINTS, -1, NBR_LOOP_CHECKPOINTS, NULL);
+    // Only the full logs were verified before TB_END
+    TB_ASSERT(nbr_verified_in_loop == 3 * TB_CHECKPOINT_LOG_SIZE, "%d checkpoints verified before TB_END",
+        nbr_verified_in_loop);
+    TB_ASSERT(tb_context_ptr->checkpoint_idx == NBR_LOOP_CHECKPOINTS, "%d checkpoints verified",
+        tb_context_ptr->checkpoint_idx);
+
+    TB_TEST_STEP("Mismatch reported at the first differing checkpoint");
+    snprintf(expected_error, sizeof(expected_error), TB_PRINT_PREFIX "TB_ASSERT failed: TB_CHECKPOINT != "
+        "TB_CHECKPOINT_SEQ[1500]: actual value=-1, expected value=1500, expected time=00:00:00.000150\n");
+    run_loop(NBR_LOOP_CHECKPOINTS, 1500, NBR_LOOP_CHECKPOINTS, expected_error);
+    tb_defs_unit_test_check_no_pending_fatal_error();
+    // The checkpoints after the mismatch are still verified
+    TB_ASSERT(tb_context_ptr->checkpoint_idx == NBR_LOOP_CHECKPOINTS, "%d checkpoints verified",
+        tb_context_ptr->checkpoint_idx);
+
+    TB_TEST_STEP("More checkpoints than items");
+    run_loop(2, -1, 1,
+        TB_PRINT_PREFIX "TB_ASSERT failed: More TB_CHECKPOINTs than items in TB_CHECKPOINT_SEQ!\n");
+    tb_defs_unit_test_check_no_pending_fatal_error();
+
+    TB_TEST_STEP("Checkpoints without TB_CHECKPOINT_SEQ");
+    run_loop(1, -1, 0, TB_PRINT_PREFIX "TB_ASSERT failed: TB_CHECKPOINT without TB_CHECKPOINT_SEQ!\n");
+    tb_defs_unit_test_check_no_pending_fatal_error();
+
+    TB_TEST_STEP("Checkpoints verified at TB_RETURN of the top level test sequence");
+    tb_defs_unit_test_reset();
+    TB_RESET(tb_context_ptr);
+    tb_defs_unit_test_expect_fatal_error(TB_PRINT_PREFIX "TB_ASSERT failed: TB_CHECKPOINT != TB_CHECKPOINT_SEQ[1]: "
+        "actual value=3, expected value=2, expected time=00:00:00.001000\n");
+    bst_ticker_set_next_tick_absolute(0);
+    tb_defs_unit_test_scheduler(return_tick);
+    tb_defs_unit_test_check_no_pending_fatal_error();
+
+    TB_TEST_STEP("Checkpoints verified at TB_FINISH");
+    tb_defs_unit_test_reset();
+    TB_RESET(tb_context_ptr);
+    TB_FINISH_HOOK(finish_hook);
+    tb_defs_unit_test_expect_fatal_error(TB_PRINT_PREFIX "TB_ASSERT failed: TB_CHECKPOINT != TB_CHECKPOINT_SEQ[1]: "
+        "actual value=3, expected value=2, expected time=00:00:00.001000\n");
+    bst_ticker_set_next_tick_absolute(0);
+    tb_defs_unit_test_scheduler(finish_tick);
+    tb_defs_unit_test_check_no_pending_fatal_error();
+    TB_ASSERT(tm_get_hw_time() == 1e3, "Run ended at %u", (unsigned int)tm_get_hw_time());
+
+    TB_TEST_STEP("Test ended - all OK!");
+    return 0;
+}
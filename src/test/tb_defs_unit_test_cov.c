@@ -0,0 +1,123 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// The purpose of this test bench is to test the coverage recording (TB_COVERAGE). The test sequence is run twice with
+// parameters taking different branches, and the expansion points reached by each run and the dumped coverage file are
+// checked, including those of a sub-sequence in an included header. The dumped file is left for the Makefile to check
+// the tb_cov_merge report of it.
+
+#define TB_COVERAGE true
+
+#include <string.h>
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs.h"
+#include "tb_defs_unit_test_cov.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Coverage test: "
+
+TB_GLOBALS
+
+#define COV_FILE "tb_defs_unit_test_cov.cov"
+
+// All expansion points of the test bench (see tb_cov_point_t)
+extern tb_cov_point_t __start_tb_cov_points[];
+extern tb_cov_point_t __stop_tb_cov_points[];
+
+static bool is_if_taken;
+static int nbr_iterations;
+static int i;
+
+TB_WATCH(int, level);
+
+static void level_up_handler(void) { TB_SET(level, level + 1); }
+
+void test_tick(bs_time_t HW_device_time)
+{
+    TB_TICK_HANDLER(test_tick);
+
+    TB_BEGIN
+
+    TB_IF(is_if_taken)
+        TB_WAIT(1)
+    TB_ELSE
+        TB_WAIT(2)
+    TB_ENDIF
+    TB_FOR(i = 0, i < nbr_iterations, i++)
+    TB_ENDFOR
+    tb_defs_unit_test_schedule_special_event_delta(10, level_up_handler);
+    tb_defs_unit_test_schedule_special_event_delta(20, level_up_handler);
+    TB_WAIT_CHANGE(level)
+    TB_WAIT_COND_WATCH(level >= 2, level)
+    TB_CALL(wait_in_header)
+
+    TB_END
+}
+
+// Number of expansion points of the file, and the number of those reached
+static unsigned int count_points(const char *file, unsigned int *nbr_reached)
+{
+    unsigned int nbr_points = 0;
+    *nbr_reached = 0;
+    for (const tb_cov_point_t *point = __start_tb_cov_points; point != __stop_tb_cov_points; point++)
+        if (strcmp(point->file, file) == 0)
+        {
+            nbr_points++;
+            *nbr_reached += point->is_reached;
+        }
+    return nbr_points;
+}
+
+static unsigned int run_test(bool if_taken, int iterations)
+{
+    unsigned int nbr_reached;
+
+    tb_restart(tb_context_ptr);
+    tb_defs_unit_test_reset();
+    tb_cov_clear();
+    is_if_taken = if_taken;
+    nbr_iterations = iterations;
+    level = 0;
+    bst_ticker_set_next_tick_absolute(0);
+    tb_defs_unit_test_scheduler(test_tick);
+    count_points(__FILE__, &nbr_reached);
+    return nbr_reached;
+}
+
+int main()
+{
+    char line[1000];
+    unsigned int nbr_reached;
+    unsigned int nbr_stars = 0;
+    FILE *f;
+
+    TB_TEST_STEP("Expansion points reached");
+    // TB_BEGIN, TB_IF, TB_WAIT(1), TB_ENDIF, TB_ENDFOR (loop exit), TB_WAIT_CHANGE, TB_WAIT_COND_WATCH, and TB_CALL
+    TB_ASSERT(run_test(true, 0) == 8, "Unexpected coverage of run 1");
+    // TB_BEGIN, TB_ELSE, TB_WAIT(2), TB_ENDIF, TB_FOR (loop body), TB_ENDFOR, TB_WAIT_CHANGE, TB_WAIT_COND_WATCH, and
+    // TB_CALL
+    TB_ASSERT(run_test(false, 2) == 9, "Unexpected coverage of run 2");
+
+    TB_TEST_STEP("Expansion points registered, reached or not");
+    TB_ASSERT(count_points(__FILE__, &nbr_reached) == 11, "Wrong number of points in " __FILE__);
+    // The sub-sequence's TB_BEGIN and TB_WAIT(3) are recorded against the header, not this file
+    TB_ASSERT(count_points("tb_defs_unit_test_cov.h", &nbr_reached) == 2 && nbr_reached == 2,
+        "Wrong points in tb_defs_unit_test_cov.h");
+
+    TB_TEST_STEP("Coverage file");
+    TB_ASSERT(tb_cov_dump(COV_FILE), "Could not write " COV_FILE);
+    f = fopen(COV_FILE, "r");
+    TB_ASSERT(f && fgets(line, sizeof(line), f) && strcmp(line, "tb_coverage 2\n") == 0, "Bad coverage file header");
+    while (fgets(line, sizeof(line), f) && !strstr(line, " tb_defs_unit_test_cov.c\n"))
+        ;
+    TB_ASSERT(!feof(f), "Coverage entry missing");
+    fclose(f);
+    for (char *p = line; *p != ' '; p++)
+        nbr_stars += *p == '*';
+    TB_ASSERT(nbr_stars == 9, "%u points reached in coverage file, expected 9", nbr_stars);
+
+    TB_TEST_STEP("Test ended - all OK!");
+    return 0;
+}
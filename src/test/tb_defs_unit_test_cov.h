@@ -0,0 +1,23 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef TB_DEFS_UNIT_TEST_COV_H
+#define TB_DEFS_UNIT_TEST_COV_H
+
+// This file contains a sub-sequence used by tb_defs_unit_test_cov.c, whose expansion points must be recorded against
+// this file rather than the file including it.
+
+#include "tb_defs.h"
+
+static void wait_in_header(TB_CONTEXT_PARAM)
+{
+    TB_BEGIN
+
+    TB_WAIT(3)
+
+    TB_END
+}
+
+#endif // #ifndef TB_DEFS_UNIT_TEST_COV_H
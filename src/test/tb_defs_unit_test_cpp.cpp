@@ -0,0 +1,71 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// The purpose of this test bench is to test tb_defs.h in a C++ test bench through the tb_defs_cpp.hpp wrapper, with
+// the constexpr checkpoint sequences. When compiled with one of the TB_DEFS_UNIT_TEST_CPP_INVALID_* macros defined, it
+// contains an invalid checkpoint sequence, which the Makefile checks is rejected at compile time.
+
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs_cpp.hpp"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "C++ test: "
+
+TB_GLOBALS
+
+static int i;
+
+void test_tick(bs_time_t HW_device_time)
+{
+    TB_CHECKPOINT_SEQ(
+        {0,1}, {1.5e3,2}, {2.5e3,3}, {3.5e3,3}, {3.5e3,4}, {3.5e3,-1}
+    );
+    TB_CHECKPOINT_BUF_SEQ(
+        {1.5e3, 0x44bc2cf5ad770999}
+    );
+
+    TB_BEGIN
+    TB_CHECKPOINT(1);
+    TB_WAIT(1.5e3);
+    TB_CHECKPOINT(2);
+    TB_CHECKPOINT_BUF("abc", 3);
+    TB_FOR(i = 0, i < 2, i++)
+        TB_WAIT(1e3);
+        TB_CHECKPOINT(3);
+    TB_ENDFOR
+    TB_CHECKPOINT(4);
+    TB_END
+}
+
+#if defined(TB_DEFS_UNIT_TEST_CPP_INVALID_UNSORTED)
+void invalid_tick(bs_time_t HW_device_time)
+{
+    TB_CHECKPOINT_SEQ({0,1}, {2e3,2}, {1e3,3});
+}
+#elif defined(TB_DEFS_UNIT_TEST_CPP_INVALID_FRACTIONAL)
+void invalid_tick(bs_time_t HW_device_time)
+{
+    TB_CHECKPOINT_SEQ({0,1}, {1.5,2});
+}
+#elif defined(TB_DEFS_UNIT_TEST_CPP_INVALID_NEGATIVE)
+void invalid_tick(bs_time_t HW_device_time)
+{
+    TB_CHECKPOINT_SEQ({-1e3,1});
+}
+#elif defined(TB_DEFS_UNIT_TEST_CPP_INVALID_BUF_UNSORTED)
+void invalid_tick(bs_time_t HW_device_time)
+{
+    TB_CHECKPOINT_BUF_SEQ({2e3, 0}, {1e3, 0});
+}
+#endif
+
+int main()
+{
+    bst_ticker_set_next_tick_absolute(0);
+    tb_defs_unit_test_scheduler(test_tick);
+    TB_CHECKPOINT(-1);
+    TB_TEST_STEP("Test ended - all OK!");
+    return 0;
+}
@@ -0,0 +1,103 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// The purpose of this test bench is to test TB_FINISH: two test bench contexts (device A and device B) in one process
+// both register, and the run must end as soon as both are finished, although their sequences still have ticks
+// scheduled. The hook must get whether both passed. After TB_RESET, the contexts can finish again.
+
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Finish test: "
+
+TB_GLOBALS
+
+static tb_context_t dev_b_context = TB_CONTEXT_INITIALIZER;
+static tb_ticker_t dev_b_ticker;
+static bool dev_b_passes;
+static unsigned int nbr_hook_calls;
+static bool hook_passed;
+static bs_time_t hook_time;
+
+static void finish_hook(bool passed)
+{
+    nbr_hook_calls++;
+    hook_passed = passed;
+    hook_time = tm_get_hw_time();
+    tb_defs_unit_test_stop();
+}
+
+void dev_a_tick(bs_time_t HW_device_time)
+{
+    TB_BEGIN
+    TB_WAIT(2e3);
+    TB_FINISH(true);
+    // Would keep the simulation running
+    TB_WHILE(true)
+        TB_WAIT(1e3);
+    TB_ENDWHILE
+    TB_END
+}
+
+void dev_b_seq(TB_CONTEXT_PARAM)
+{
+    TB_TICKER(&dev_b_ticker);
+
+    TB_BEGIN
+    TB_WAIT(5e3);
+    TB_FINISH(dev_b_passes);
+    TB_WAIT(100e3);
+    TB_END
+}
+
+void dev_b_tick(bs_time_t HW_device_time)
+{
+    dev_b_seq(&dev_b_context);
+}
+
+static void run(bool dev_b_pass)
+{
+    tb_defs_unit_test_reset();
+    TB_RESET(tb_context_ptr);
+    TB_RESET(&dev_b_context);
+    dev_b_passes = dev_b_pass;
+    nbr_hook_calls = 0;
+    bst_ticker_set_next_tick_absolute(0);
+    tb_defs_unit_test_device_set_next_tick_absolute(dev_b_ticker.arg, 0);
+    tb_defs_unit_test_scheduler(dev_a_tick);
+}
+
+int main()
+{
+    dev_b_ticker.set_next_tick_absolute = tb_defs_unit_test_device_set_next_tick_absolute;
+    dev_b_ticker.arg = tb_defs_unit_test_add_device(dev_b_tick);
+    TB_FINISH_REGISTER(tb_context_ptr);
+    TB_FINISH_REGISTER(&dev_b_context);
+    TB_FINISH_HOOK(finish_hook);
+
+    TB_TEST_STEP("Run ended when both devices are finished, one failed");
+    run(false);
+    TB_ASSERT(nbr_hook_calls == 1 && !hook_passed && hook_time == 5e3, "Hook called %u times, at %u, passed %d",
+        nbr_hook_calls, (unsigned int)hook_time, hook_passed);
+    TB_ASSERT(tm_get_hw_time() == 5e3, "Run ended at %u", (unsigned int)tm_get_hw_time());
+    TB_ASSERT(tb_context_ptr->finish_status == TB_FINISH_PASSED && dev_b_context.finish_status == TB_FINISH_FAILED,
+        "Wrong finish status");
+
+    TB_TEST_STEP("Run ended again after TB_RESET, both passed");
+    run(true);
+    TB_ASSERT(nbr_hook_calls == 1 && hook_passed && hook_time == 5e3, "Hook called %u times, at %u, passed %d",
+        nbr_hook_calls, (unsigned int)hook_time, hook_passed);
+
+    TB_TEST_STEP("Finishing twice");
+    tb_defs_unit_test_expect_fatal_error(TB_PRINT_PREFIX "TB_ASSERT failed: TB_FINISH of a finished test bench "
+        "context\n");
+    TB_FINISH(true);
+    tb_defs_unit_test_check_no_pending_fatal_error();
+    TB_ASSERT(nbr_hook_calls == 1, "Hook called again");
+
+    TB_TEST_STEP("Test ended - all OK!");
+    return 0;
+}
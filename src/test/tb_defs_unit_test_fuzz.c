@@ -0,0 +1,83 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// The purpose of this test bench is to test the randomized waits (TB_WAIT_RAND/TB_WAIT_JITTER) and the seed sweep
+// (TB_SEED_SWEEP). The test sequence contains a deliberate timing bug which only shows up for some seeds; the sweep must
+// find exactly those seeds.
+// Usage: tb_defs_unit_test_fuzz [-tb_seeds=<first seed>:<number of seeds>]
+
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Fuzz test: "
+
+TB_GLOBALS
+
+#define MAX_FAILING_SEEDS 10000
+
+static bs_time_t start_time;
+static bool is_done;
+
+void test_tick(bs_time_t HW_device_time)
+{
+    TB_BEGIN
+
+    TB_WAIT_RAND(0, 99);
+    // Deliberate timing bug
+    TB_ASSERT(tm_get_hw_time() % 10 != 7, "Timing bug hit");
+    start_time = tm_get_hw_time();
+    TB_WAIT_JITTER(1e3, 10);
+    TB_ASSERT(tm_get_hw_time() - start_time >= 900 && tm_get_hw_time() - start_time <= 1100, "Jitter out of range");
+    is_done = true;
+
+    TB_END
+}
+
+static bool run_test(uint64_t seed)
+{
+    tb_defs_unit_test_reset();
+    is_done = false;
+    bst_ticker_set_next_tick_absolute(0);
+    tb_defs_unit_test_scheduler(test_tick);
+    return is_done;
+}
+
+int main(int argc, char *argv[])
+{
+    static uint64_t failing_seeds[MAX_FAILING_SEEDS];
+    uint64_t first_seed = 0;
+    unsigned int nbr_seeds = 1000;
+    unsigned int nbr_failing_seeds;
+    unsigned int nbr_expected_failing_seeds = 0;
+    tb_context_t reference_context;
+    int i;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!tb_parse_seed_arg(argv[i], &first_seed, &nbr_seeds))
+            tb_defs_unit_test_fatal_error(__LINE__, 0, "Unknown argument %s\n", argv[i]);
+    }
+
+    nbr_failing_seeds = TB_SEED_SWEEP(first_seed, nbr_seeds, run_test, failing_seeds, MAX_FAILING_SEEDS);
+
+    // The failing seeds must be exactly those for which the first draw of the generator hits the timing bug
+    for (i = 0; i < nbr_seeds; i++)
+    {
+        tb_rand_seed(&reference_context, first_seed + i);
+        if (tb_rand_range(&reference_context, 0, 99) % 10 == 7)
+        {
+            TB_ASSERT(nbr_expected_failing_seeds < nbr_failing_seeds &&
+                failing_seeds[nbr_expected_failing_seeds] == first_seed + i, "Seed %d not found failing", i);
+            nbr_expected_failing_seeds++;
+        }
+    }
+    TB_ASSERT(nbr_failing_seeds == nbr_expected_failing_seeds, "%u seeds failed, %u expected", nbr_failing_seeds,
+        nbr_expected_failing_seeds);
+    TB_ASSERT(nbr_seeds < 1000 || (nbr_failing_seeds > nbr_seeds / 20 && nbr_failing_seeds < nbr_seeds / 5),
+        "Unexpected distribution: %u of %u seeds failed", nbr_failing_seeds, nbr_seeds);
+    TB_TEST_STEP("Test ended - all OK!");
+    return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// The purpose of this test bench is to test a mailbox bound at static initialization (TB_GLOBALS_W_MAILBOX): messages
+// sent by an event handler before the test sequence has been entered for the first time must not be lost, and must be
+// received in order with the messages sent later. TB_MSG_SEND must be a single statement, and using a context without
+// a mailbox must fail the test.
+
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Mailbox test: "
+
+typedef struct
+{
+    int val;
+} test_msg_t;
+
+TB_GLOBALS_W_MAILBOX(test_msg_t, 4)
+
+void test_tick(bs_time_t HW_device_time);
+
+static int next_msg_val = 1;
+static bool is_sequence_started;
+static test_msg_t *msg;
+static tb_context_t no_mailbox_context = TB_CONTEXT_INITIALIZER;
+
+static void msg_handler(void)
+{
+    test_msg_t *new_msg = TB_MSG_RESERVE();
+    new_msg->val = next_msg_val++;
+    TB_MSG_SEND(test_tick);
+}
+
+void test_tick(bs_time_t HW_device_time)
+{
+    TB_CHECKPOINT_SEQ(
+        {0,1}, {0,2}, {1e3,3}
+    );
+
+    TB_BEGIN
+    is_sequence_started = true;
+
+    TB_TEST_STEP("Messages sent before the first entry");
+    while (TB_MSG_NEXT(msg))
+        TB_CHECKPOINT(msg->val);
+
+    TB_TEST_STEP("Message sent after the first entry");
+    tb_defs_unit_test_schedule_special_event_delta(1e3, msg_handler);
+    // Also received when the entry counter of the run summary has wrapped around
+    tb_context_ptr->nbr_entries = 0;
+    TB_WAIT_MSG(msg);
+    TB_CHECKPOINT(msg->val);
+    TB_END
+}
+
+static bool next_msg(TB_CONTEXT_PARAM)
+{
+    return TB_MSG_NEXT(msg);
+}
+
+static void release_msg(TB_CONTEXT_PARAM)
+{
+    TB_MSG_RELEASE
+}
+
+int main()
+{
+    unsigned int nbr_signals;
+
+    msg_handler();
+    msg_handler();
+    TB_ASSERT(!is_sequence_started, "Sequence started by the messages");
+    bst_ticker_set_next_tick_absolute(0);
+    tb_defs_unit_test_scheduler(test_tick);
+    TB_ASSERT(tb_context_ptr->checkpoint_idx == tb_context_ptr->nbr_checkpoints, "Sequence not completed");
+
+    TB_TEST_STEP("TB_MSG_SEND as the body of an if");
+    nbr_signals = tb_context_ptr->nbr_signals;
+    if (!is_sequence_started)
+        TB_MSG_SEND(test_tick);
+    TB_ASSERT(tb_context_ptr->nbr_signals == nbr_signals, "Event signalled by TB_MSG_SEND not executed");
+
+    TB_TEST_STEP("Context without mailbox");
+    tb_defs_unit_test_expect_fatal_error(TB_PRINT_PREFIX "TB_ASSERT failed: TB_MSG_NEXT or TB_WAIT_MSG without "
+        "TB_MAILBOX!\n");
+    TB_ASSERT(!next_msg(&no_mailbox_context), "Message without mailbox");
+    tb_defs_unit_test_check_no_pending_fatal_error();
+    tb_defs_unit_test_expect_fatal_error(TB_PRINT_PREFIX "TB_ASSERT failed: TB_MSG_RELEASE without TB_MAILBOX!\n");
+    release_msg(&no_mailbox_context);
+    tb_defs_unit_test_check_no_pending_fatal_error();
+
+    TB_TEST_STEP("Test ended - all OK!");
+    return 0;
+}
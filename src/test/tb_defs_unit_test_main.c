@@ -27,6 +27,32 @@ void test_init()
 
 static int i, j;
 static bool event1 = false;
+static unsigned int nbr_signal_entries;
+
+typedef struct
+{
+    int val;
+} test_msg_t;
+
+static int next_msg_val;
+static test_msg_t *msg;
+
+static unsigned char payload[1024];
+
+void msg_event_handler(void)
+{
+    test_msg_t *new_msg = TB_MSG_RESERVE();
+    new_msg->val = next_msg_val++;
+    bs_trace_raw_time(3, TB_PRINT_PREFIX "Message %d sent\n", new_msg->val);
+    TB_MSG_SEND(test_tick);
+}
+
+static bool is_special_event_handled;
+
+void special_event_handler(void)
+{
+    is_special_event_handled = true;
+}
 
 void event1_handler(void)
 {
@@ -51,7 +77,7 @@ void test_tick(bs_time_t HW_device_time)
 {
     TB_CHECKPOINT_SEQ(
         // TB_ASSERT test
-        {0,0},
+        {0,0}, {0,98},
 
         // WAIT test
         {0,1}, {1e6,2}, {1e6,3}, {5e6,4},
@@ -90,11 +116,31 @@ void test_tick(bs_time_t HW_device_time)
         {132e6,10000}, {134e6,10001}, {134e6,10004}, {134e6,10005}, {134e6,72},
         {134e6,10000}, {136e6,10001}, {136e6,10004}, {137e6,10001}, {137e6,10002}, {137e6,10100}, {138e6,10101}, {138e6,10003}, {138e6,73},
 
+        // SIGNAL_EVENT coalescing test
+        {140.5e6,80}, {141.5e6,81}, {141.5e6,82}, {142.5e6,83},
+
+        // MSG test
+        {151e6,90}, {151e6,91}, {151.5e6,92}, {152e6,93}, {153e6,94}, {153e6,95}, {153e6,96}, {153e6,97},
+
+        // CHECKPOINT_BUF test
+        {160e6,100}, {161e6,101},
+
+        // Expression arguments test
+        {171e6,110}, {172e6,111}, {173e6,112},
+
         // END
         {900e6,-2},
         {900e6,-1},
     );
 
+    TB_CHECKPOINT_BUF_SEQ(
+        // Reference XXH64 values
+        {160e6, 0xef46db3751d8e999}, {160e6, 0x44bc2cf5ad770999}, {160e6, 0xfbcea83c8a378bf1},
+        {161e6, 0xe6816a6e134b7a33}, {161e6, 0xe6816a6e134b7a33},
+    );
+
+    TB_MAILBOX(test_msg_t, 4);
+
     TB_BEGIN
 
     TB_TEST_STEP("TB_ASSERT test");
@@ -103,6 +149,10 @@ void test_tick(bs_time_t HW_device_time)
     TB_ASSERT(false, "Value %d", 123);
     tb_defs_unit_test_check_no_pending_fatal_error();
     TB_CHECKPOINT(0);
+    tb_defs_unit_test_expect_fatal_error(TB_PRINT_PREFIX "TB_ASSERT failed: TB_CHECKPOINT != TB_CHECKPOINT_SEQ[1]: "
+        "actual value=99, expected value=98, expected time=00:00:00.000000\n");
+    TB_CHECKPOINT(99);
+    tb_defs_unit_test_check_no_pending_fatal_error();
 
     TB_TEST_STEP("WAIT test");
     TB_CHECKPOINT(1);
@@ -110,7 +160,11 @@ void test_tick(bs_time_t HW_device_time)
     TB_CHECKPOINT(2);
     TB_WAIT(0);
     TB_CHECKPOINT(3);
+    // A special event at the time of the tick is handled before the tick
+    tb_defs_unit_test_schedule_special_event_delta(4e6, special_event_handler);
+    is_special_event_handled = false;
     TB_WAIT(4e6);
+    TB_ASSERT(is_special_event_handled, "Special event not handled before the tick at the same time");
     TB_CHECKPOINT(4);
 
     TB_TEST_STEP("WAIT_UNTIL test");
@@ -340,6 +394,89 @@ void test_tick(bs_time_t HW_device_time)
     TB_CALL(test_sub_func_in_other_file, 3, event1);
     TB_CHECKPOINT(73);
 
+    TB_WAIT_UNTIL(140e6);
+    TB_TEST_STEP("SIGNAL_EVENT coalescing test");
+    // Set three events to occur at the same time during the following WAIT_COND; with TB_DEFER_SIGNALS they must cause
+    // a single tick handler entry
+    for (i = 0; i < 3; i++)
+        tb_defs_unit_test_schedule_special_event_delta(0.5e6, event1_handler);
+    event1 = false;
+    nbr_signal_entries = tb_context_ptr->nbr_signal_entries;
+    TB_WAIT_COND(event1);
+    TB_CHECKPOINT(80);
+    TB_WAIT(1e6);
+    TB_ASSERT(tb_context_ptr->nbr_signal_entries - nbr_signal_entries == (TB_DEFER_SIGNALS ? 1 : 3),
+        "%u signal entries", tb_context_ptr->nbr_signal_entries - nbr_signal_entries);
+    TB_CHECKPOINT(81);
+    // Signal an event from within the tick handler itself
+    event1 = true;
+    TB_SIGNAL_EVENT(test_tick);
+    TB_WAIT_COND(event1);
+    TB_CHECKPOINT(82);
+    TB_WAIT(1e6);
+    TB_CHECKPOINT(83);
+    TB_TEST_STEP("Signal coalescing ratio %.2f", TB_SIGNAL_COALESCING_RATIO);
+
+    TB_WAIT_UNTIL(150e6);
+    TB_TEST_STEP("MSG test");
+    // Send two messages before the sequence resumes; none of them must be lost
+    next_msg_val = 90;
+    tb_defs_unit_test_schedule_special_event_delta(0.2e6, msg_event_handler);
+    tb_defs_unit_test_schedule_special_event_delta(0.4e6, msg_event_handler);
+    TB_WAIT(1e6);
+    // TB_WAIT_MSG when messages are already available (should not wait)
+    TB_WAIT_MSG(msg);
+    TB_CHECKPOINT(msg->val);
+    while (TB_MSG_NEXT(msg))
+        TB_CHECKPOINT(msg->val);
+    // TB_WAIT_MSG when no message is available yet (should end when message arrives)
+    tb_defs_unit_test_schedule_special_event_delta(0.5e6, msg_event_handler);
+    TB_WAIT_MSG(msg);
+    TB_CHECKPOINT(msg->val);
+    // TB_WAIT_MSG_W_DEADLINE when no message arrives (should end at deadline with no message)
+    TB_WAIT_MSG_W_DEADLINE(msg, 152e6);
+    TB_CHECKPOINT(msg == NULL ? 93 : -99);
+    // Fill the mailbox to its capacity, and drain it in one resumption
+    next_msg_val = 94;
+    for (i = 0; i < 4; i++)
+        tb_defs_unit_test_schedule_special_event_delta(0.5e6, msg_event_handler);
+    TB_WAIT(1e6);
+    TB_WAIT_MSG_W_DEADLINE_DELTA(msg, 1e6);
+    TB_CHECKPOINT(msg->val);
+    while (TB_MSG_NEXT(msg))
+        TB_CHECKPOINT(msg->val);
+
+    TB_WAIT_UNTIL(160e6);
+    TB_TEST_STEP("CHECKPOINT_BUF test");
+    TB_CHECKPOINT_BUF(NULL, 0);
+    TB_CHECKPOINT_BUF("abc", 3);
+    TB_CHECKPOINT_BUF("Nobody inspects the spammish repetition", 39);
+    TB_CHECKPOINT(100);
+    for (i = 0; i < sizeof(payload); i++)
+        payload[i] = i * 7 + 3;
+    TB_WAIT(1e6);
+    TB_CHECKPOINT_BUF(payload, sizeof(payload));
+    // A single changed byte must be detected
+    payload[512] ^= 1;
+    tb_defs_unit_test_expect_fatal_error(TB_PRINT_PREFIX "TB_ASSERT failed: TB_CHECKPOINT_BUF != TB_CHECKPOINT_BUF_SEQ[4]: "
+        "actual hash=0xaa97c45ce1d95f3f, expected hash=0xe6816a6e134b7a33, expected time=00:02:41.000000\n");
+    TB_CHECKPOINT_BUF(payload, sizeof(payload));
+    tb_defs_unit_test_check_no_pending_fatal_error();
+    TB_CHECKPOINT(101);
+
+    TB_WAIT_UNTIL(170e6);
+    TB_TEST_STEP("Expression arguments test");
+    // Delays given as expressions binding less tightly than the addition of the current time
+    event1 = false;
+    TB_WAIT(!event1 ? 1e6 : 0);
+    TB_CHECKPOINT(110);
+    TB_WAIT_COND_W_DEADLINE_DELTA(event1, !event1 ? 1e6 : 0);
+    TB_CHECKPOINT(111);
+    tb_defs_unit_test_expect_fatal_error(TB_PRINT_PREFIX "TB_ASSERT failed: TB_WAIT_COND_ASSERT failed: Event1 didn't occur\n");
+    TB_WAIT_COND_ASSERT(event1, !event1 ? 1e6 : 0, "Event%d didn't occur", 1);
+    tb_defs_unit_test_check_no_pending_fatal_error();
+    TB_CHECKPOINT(112);
+
     TB_WAIT_UNTIL(900e6);
     TB_TEST_STEP("Final");
     TB_CHECKPOINT(-2);
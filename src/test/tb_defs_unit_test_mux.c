@@ -0,0 +1,86 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// The purpose of this test bench is to test the tick multiplexer: a main test sequence (in this file) and a background
+// monitor sequence (in tb_defs_unit_test_mux_monitor.c) share one device ticker, with ticks at the same and at
+// different times, and with the monitor waking up the main sequence via a TB_EVENT. A third tick handler, which
+// never schedules a tick after its first, must not be called again.
+
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs.h"
+#include "tb_defs_unit_test_mux.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Main: "
+
+TB_GLOBALS
+
+tb_event_t supervision_timeout = TB_EVENT_INIT;
+
+static tb_ticker_t device_ticker;
+static tb_tick_mux_t mux = TB_TICK_MUX_INIT(&device_ticker);
+static tb_mux_ticker_t main_mux_ticker;
+static tb_mux_ticker_t idle_mux_ticker;
+static unsigned int nbr_device_ticks;
+static unsigned int nbr_main_entries;
+static unsigned int nbr_idle_entries;
+
+void device_tick(bs_time_t HW_device_time)
+{
+    nbr_device_ticks++;
+    TB_TICK_MUX_DISPATCH(mux);
+}
+
+void idle_tick(bs_time_t HW_device_time)
+{
+    nbr_idle_entries++;
+}
+
+void main_tick(bs_time_t HW_device_time)
+{
+    TB_CHECKPOINT_SEQ(
+        {1e3,1}, {7e3,2}, {10.5e3,3}, {11.5e3,4}, {14e3,-1}
+    );
+    TB_TICK_HANDLER(main_tick);
+    TB_TICKER(&main_mux_ticker.ticker);
+
+    nbr_main_entries++;
+
+    TB_BEGIN
+
+    TB_TEST_STEP("Ticks at other times than the monitor");
+    TB_WAIT(1e3);
+    TB_CHECKPOINT(1);
+
+    TB_TEST_STEP("Tick at the same time as the monitor");
+    TB_WAIT_UNTIL(7e3);
+    TB_CHECKPOINT(2);
+
+    TB_TEST_STEP("Woken up by the monitor");
+    TB_EVENT_WAIT(supervision_timeout);
+    TB_CHECKPOINT(3);
+    TB_WAIT(1e3);
+    TB_CHECKPOINT(4);
+
+    TB_END
+}
+
+int main()
+{
+    device_ticker.set_next_tick_absolute = tb_defs_unit_test_device_set_next_tick_absolute;
+    device_ticker.arg = tb_defs_unit_test_add_device(device_tick);
+    TB_TICK_MUX_ADD(mux, main_mux_ticker, main_tick);
+    TB_TICK_MUX_ADD(mux, monitor_mux_ticker, monitor_tick);
+    TB_TICK_MUX_ADD(mux, idle_mux_ticker, idle_tick);
+    tb_defs_unit_test_scheduler(NULL);
+    TB_CHECKPOINT(-1);
+    monitor_check_done();
+    // One device tick at each distinct tick time: 0, 1e3, 11.5e3, and the 20 monitor rounds (including 7e3 and 10.5e3)
+    TB_ASSERT(nbr_device_ticks == 23, "%u device ticks", nbr_device_ticks);
+    TB_ASSERT(nbr_main_entries == 5, "%u main sequence entries", nbr_main_entries);
+    TB_ASSERT(nbr_idle_entries == 1, "%u idle tick handler entries", nbr_idle_entries);
+    TB_TEST_STEP("Test ended - all OK!");
+    return 0;
+}
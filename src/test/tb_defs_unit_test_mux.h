@@ -0,0 +1,20 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef TB_DEFS_UNIT_TEST_MUX_H
+#define TB_DEFS_UNIT_TEST_MUX_H
+
+// This file contains the definitions shared by the two test bench contexts of tb_defs_unit_test_mux.c.
+
+#include "tb_defs.h"
+
+extern tb_event_t supervision_timeout;
+
+extern tb_mux_ticker_t monitor_mux_ticker;
+void main_tick(bs_time_t HW_device_time);
+void monitor_tick(bs_time_t HW_device_time);
+void monitor_check_done(void);
+
+#endif // #ifndef TB_DEFS_UNIT_TEST_MUX_H
@@ -0,0 +1,40 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// This file contains the background monitor test bench context used by tb_defs_unit_test_mux.c.
+
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs.h"
+#include "tb_defs_unit_test_mux.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Monitor: "
+
+TB_GLOBALS
+
+#define MONITOR_INTERVAL 700
+#define NBR_MONITOR_ROUNDS 20
+
+tb_mux_ticker_t monitor_mux_ticker;
+static unsigned int round_idx;
+
+void monitor_tick(bs_time_t HW_device_time)
+{
+    TB_TICKER(&monitor_mux_ticker.ticker);
+
+    TB_BEGIN
+    TB_FOR(round_idx = 1, round_idx <= NBR_MONITOR_ROUNDS, round_idx++)
+        TB_WAIT(MONITOR_INTERVAL);
+        TB_ASSERT(tm_get_hw_time() == round_idx * MONITOR_INTERVAL, "Round %u at wrong time", round_idx);
+        if (round_idx == 15)
+            TB_EVENT_SET(supervision_timeout);
+    TB_ENDFOR
+    TB_END
+}
+
+void monitor_check_done(void)
+{
+    TB_ASSERT(round_idx == NBR_MONITOR_ROUNDS + 1, "Monitor ended after %u rounds", round_idx - 1);
+}
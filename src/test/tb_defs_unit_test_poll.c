@@ -0,0 +1,88 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// The purpose of this test bench is to test TB_WAIT_COND_POLL: a condition changed without TB_SIGNAL_EVENT is detected
+// at the next re-check of the backoff schedule, a signalled event wakes the sequence up immediately, an event not making
+// the condition true leaves the schedule unchanged, and the deadline ends the wait.
+
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Poll test: "
+
+TB_GLOBALS
+
+void test_tick(bs_time_t HW_device_time);
+
+static bool is_reg_ready;
+static bool is_never_true;
+static unsigned int nbr_entries;
+static unsigned int first_entry;
+
+// Peripheral model changing the register without signalling it
+void reg_ready_handler(void)
+{
+    is_reg_ready = true;
+}
+
+void reg_ready_signal_handler(void)
+{
+    is_reg_ready = true;
+    TB_SIGNAL_EVENT(test_tick);
+}
+
+void spurious_signal_handler(void)
+{
+    TB_SIGNAL_EVENT(test_tick);
+}
+
+void test_tick(bs_time_t HW_device_time)
+{
+    TB_CHECKPOINT_SEQ(
+        {11270,1}, {11393,2}, {20e3,3}, {20e3,4}, {20e3,-1}
+    );
+
+    nbr_entries++;
+
+    TB_BEGIN
+
+    TB_TEST_STEP("Condition changed without event");
+    TB_WAIT(1e3);
+    // Re-checked after 10, 30, 70, 150, 310, 630, 1270, 2270, ... 10270 us; the register changes after 10000 us
+    is_reg_ready = false;
+    tb_defs_unit_test_schedule_special_event_delta(10e3, reg_ready_handler);
+    tb_defs_unit_test_schedule_special_event_delta(500, spurious_signal_handler);
+    first_entry = nbr_entries;
+    TB_WAIT_COND_POLL(is_reg_ready, 10, 1e3, TIME_NEVER);
+    TB_CHECKPOINT(1);
+    TB_ASSERT(nbr_entries - first_entry == 17, "%u entries instead of 16 re-checks and 1 event",
+        nbr_entries - first_entry);
+
+    TB_TEST_STEP("Condition changed with event");
+    is_reg_ready = false;
+    tb_defs_unit_test_schedule_special_event_delta(123, reg_ready_signal_handler);
+    TB_WAIT_COND_POLL(is_reg_ready, 10, 1e3, TIME_NEVER);
+    TB_CHECKPOINT(2);
+
+    TB_TEST_STEP("Deadline");
+    TB_WAIT_COND_POLL(is_never_true, 100, 1e3, 20e3);
+    TB_CHECKPOINT(3);
+
+    TB_TEST_STEP("Condition already true");
+    TB_WAIT_COND_POLL(is_reg_ready, 100, 1e3, TIME_NEVER);
+    TB_CHECKPOINT(4);
+
+    TB_END
+}
+
+int main()
+{
+    bst_ticker_set_next_tick_absolute(0);
+    tb_defs_unit_test_scheduler(test_tick);
+    TB_CHECKPOINT(-1);
+    TB_TEST_STEP("Test ended - all OK!");
+    return 0;
+}
@@ -0,0 +1,125 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// The purpose of this test bench is to test TB_RESET, TB_LOCAL, and TB_RUN_TABLE. The rows of a parameter table are run
+// back-to-back; one of them fails in the middle of a sub-test sequence, which must not affect the following rows. A
+// sequence reset while waiting for a semaphore must no longer be waiting for it.
+
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Reset test: "
+
+TB_GLOBALS
+
+typedef struct
+{
+    bs_time_t delay;
+    int nbr_iterations;
+    int failing_iteration;      // -1 if none
+} scenario_t;
+
+static const scenario_t scenarios[] =
+{
+    { 1e3, 3, -1 },
+    { 5e3, 1, -1 },
+    { 2e3, 4, 2 },
+    { 1e3, 2, -1 },
+    { 7e3, 0, -1 },
+};
+
+#define NBR_SCENARIOS (sizeof(scenarios) / sizeof(scenarios[0]))
+
+static const scenario_t *scenario;
+static bs_time_t end_time;
+
+void sub_func(TB_CONTEXT_PARAM, int iteration)
+{
+    TB_LOCAL(int, nbr_calls, 0);
+
+    TB_BEGIN
+    nbr_calls++;
+    TB_ASSERT(nbr_calls == iteration + 1, "Sub-test sequence local not reset (%d calls)", nbr_calls);
+    TB_WAIT(scenario->delay);
+    TB_ASSERT(iteration != scenario->failing_iteration, "Deliberate failure in iteration %d", iteration);
+    TB_END
+}
+
+void test_tick(bs_time_t HW_device_time)
+{
+    // A single checkpoint, so that a checkpoint index not reset by the previous run makes the test fail
+    TB_CHECKPOINT_SEQ({0,-1});
+    TB_LOCAL(int, iteration, 0);
+
+    TB_BEGIN
+    TB_CHECKPOINT(-1);
+    TB_WHILE(iteration < scenario->nbr_iterations)
+        TB_CALL(sub_func, iteration);
+        iteration++;
+    TB_ENDWHILE
+    end_time = tm_get_hw_time();
+    TB_END
+}
+
+static tb_sem_t reset_sem = TB_SEM_INIT(0);
+static int nbr_sem_takes;
+
+void sem_tick(bs_time_t HW_device_time)
+{
+    TB_TICK_HANDLER(sem_tick);
+
+    TB_BEGIN
+    TB_SEM_TAKE(reset_sem);
+    nbr_sem_takes++;
+    TB_END
+}
+
+static void give_sem(void)
+{
+    TB_SEM_GIVE(reset_sem);
+}
+
+static bool run_scenario(unsigned int row)
+{
+    tb_defs_unit_test_reset();
+    scenario = &scenarios[row];
+    end_time = TIME_NEVER;
+    bst_ticker_set_next_tick_absolute(0);
+    tb_defs_unit_test_scheduler(test_tick);
+    return end_time == scenario->delay * scenario->nbr_iterations;
+}
+
+int main()
+{
+    uint64_t failing_rows[NBR_SCENARIOS];
+    unsigned int nbr_failing_rows;
+
+    nbr_failing_rows = TB_RUN_TABLE(scenarios, run_scenario, failing_rows, NBR_SCENARIOS);
+    TB_ASSERT(nbr_failing_rows == 1 && failing_rows[0] == 2, "%u rows failed, expected only row 2", nbr_failing_rows);
+
+    // Rerun the first scenario after TB_RESET, like TB_RUN_TABLE does
+    TB_RESET(tb_context_ptr);
+    TB_ASSERT(run_scenario(0), "Rerun after TB_RESET failed");
+
+    TB_TEST_STEP("Reset while waiting for a semaphore");
+    tb_defs_unit_test_reset();
+    TB_RESET(tb_context_ptr);
+    bst_ticker_set_next_tick_absolute(0);
+    tb_defs_unit_test_scheduler(sem_tick);
+    TB_ASSERT(reset_sem.waiters.first == tb_context_ptr, "Not waiting for the semaphore");
+    TB_RESET(tb_context_ptr);
+    TB_ASSERT(reset_sem.waiters.first == NULL, "Still waiting for the semaphore after TB_RESET");
+    // The sequence waits again, and takes the semaphore given once
+    tb_defs_unit_test_reset();
+    bst_ticker_set_next_tick_absolute(0);
+    tb_defs_unit_test_schedule_special_event_delta(1e3, give_sem);
+    tb_defs_unit_test_scheduler(sem_tick);
+    TB_ASSERT(nbr_sem_takes == 1 && reset_sem.count == 0 && reset_sem.waiters.first == NULL,
+        "Semaphore taken %d times, count %u", nbr_sem_takes, reset_sem.count);
+
+    TB_TEST_STEP("Test ended - all OK!");
+    return 0;
+}
@@ -0,0 +1,291 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// The purpose of this test bench is to test tb_script.h: a script (tb_defs_unit_test_script.tbs) must be scheduled
+// exactly like the equivalent macro sequence (same checkpoints, same number of tick handler entries), both as text and
+// compiled, must start over after being aborted by TB_CALL_W_DEADLINE, and script errors must be reported. A script
+// with a CHECKPOINT_SEQ must check its checkpoints against it also when called by a sequence with a TB_CHECKPOINT_SEQ,
+// and must log them with deferred checkpoint verification. A loaded script must not be run by a second context.
+
+#include <string.h>
+#include "tb_defs_unit_test_utils.h"
+#include "tb_script.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Script test: "
+
+#define SCRIPT_PATH "tb_defs_unit_test_script.tbs"
+#define COMPILED_SCRIPT_PATH "tb_defs_unit_test_script.tbc"
+#define CHECKPOINTS_SCRIPT_PATH "tb_defs_unit_test_script_checkpoints.tbs"
+
+TB_GLOBALS
+
+static tb_context_t other_context = TB_CONTEXT_INITIALIZER;
+static tb_defs_unit_test_tick_handler_t current_tick;
+static tb_script_t *script;
+static unsigned int nbr_entries;
+static unsigned int nbr_rx;
+static unsigned int nbr_rx_handled;
+static unsigned int count_val;
+static unsigned int nbr_logged;
+static int i;
+
+static void rx_handler(void)
+{
+    nbr_rx++;
+    TB_SIGNAL_EVENT(current_tick);
+}
+
+static bool is_more_rx(void) { return nbr_rx_handled < 3; }
+static bool is_rx_pending(void) { return nbr_rx > nbr_rx_handled; }
+static bool is_odd(void) { return nbr_rx_handled % 2 == 1; }
+static bool is_never(void) { return false; }
+static bool is_count_odd(void) { return count_val % 2 == 1; }
+static bool is_count_4(void) { return count_val == 4; }
+static void start_rx(void) { tb_defs_unit_test_schedule_special_event_delta(500, rx_handler); }
+static void handle_rx(void) { nbr_rx_handled++; }
+static void clear_count(void) { count_val = 0; }
+static void count(void) { count_val++; }
+static void get_nbr_logged(void) { nbr_logged = tb_context_ptr->checkpoint_log ? tb_context_ptr->checkpoint_log->nbr : 0; }
+
+static const tb_script_binding_t bindings[] =
+{
+    TB_SCRIPT_PRED(is_more_rx), TB_SCRIPT_PRED(is_rx_pending), TB_SCRIPT_PRED(is_odd), TB_SCRIPT_PRED(is_never),
+    TB_SCRIPT_PRED(is_count_odd), TB_SCRIPT_PRED(is_count_4), TB_SCRIPT_ACTION(start_rx),
+    TB_SCRIPT_ACTION(handle_rx), TB_SCRIPT_ACTION(clear_count), TB_SCRIPT_ACTION(count),
+    TB_SCRIPT_ACTION(get_nbr_logged)
+};
+
+static const tb_script_binding_t partial_bindings[] =
+{
+    TB_SCRIPT_PRED(is_more_rx), TB_SCRIPT_ACTION(start_rx)
+};
+
+void wait_once(TB_CONTEXT_PARAM)
+{
+    TB_BEGIN
+    TB_WAIT(100);
+    TB_END
+}
+
+void wait_twice(TB_CONTEXT_PARAM)
+{
+    TB_BEGIN
+    TB_WAIT(100);
+    TB_CALL(wait_once);
+    TB_RETURN
+    TB_CHECKPOINT(99);
+    TB_END
+}
+
+// The equivalent of tb_defs_unit_test_script.tbs
+void macro_tick(bs_time_t HW_device_time)
+{
+    TB_CHECKPOINT_SEQ(
+        {0,1}, {1e3,2}, {5e3,3}, {5e3,4}, {5e3,4}, {5.5e3,5}, {6e3,6}, {6.5e3,5},
+        {8.5e3,7}, {8.7e3,8}, {8.7e3,9}, {8.7e3,9}, {8.7e3,10}
+    );
+
+    nbr_entries++;
+
+    TB_BEGIN
+    TB_TEST_STEP("Waits");
+    TB_CHECKPOINT(1);
+    TB_WAIT(1e3);
+    TB_CHECKPOINT(2);
+    TB_WAIT_UNTIL(5e3);
+    TB_CHECKPOINT(3);
+
+    TB_TEST_STEP("Loops and conditions");
+    TB_FOR(i = 0, i < 2, i++)
+        TB_CHECKPOINT(4);
+    TB_ENDFOR
+    TB_WHILE(is_more_rx())
+        start_rx();
+        TB_WAIT_COND(is_rx_pending());
+        handle_rx();
+        TB_IF(is_odd())
+            TB_CHECKPOINT(5);
+        TB_ELSIF(is_never())
+            TB_CHECKPOINT(99);
+        TB_ELSE
+            TB_CHECKPOINT(6);
+        TB_ENDIF
+    TB_ENDWHILE
+
+    TB_TEST_STEP("Deadline");
+    TB_WAIT_COND_W_DEADLINE_DELTA(is_never(), 2e3);
+    TB_CHECKPOINT(7);
+    TB_ASSERT(!is_never(), "is_never");
+
+    TB_TEST_STEP("Procedures");
+    TB_CALL(wait_twice);
+    TB_CHECKPOINT(8);
+
+    TB_TEST_STEP("BREAK and CONTINUE");
+    clear_count();
+    TB_FOR(i = 0, i < 10, i++)
+        count();
+        TB_IF(is_count_odd())
+            TB_CONTINUE;
+        TB_ENDIF
+        TB_CHECKPOINT(9);
+        TB_IF(is_count_4())
+            TB_BREAK;
+        TB_ENDIF
+    TB_ENDFOR
+    TB_CHECKPOINT(10);
+    TB_END
+}
+
+void script_tick(bs_time_t HW_device_time)
+{
+    nbr_entries++;
+
+    TB_BEGIN
+    TB_SCRIPT(script);
+    TB_END
+}
+
+// The script, called by a sequence with checkpoints of its own
+void script_w_seq_tick(bs_time_t HW_device_time)
+{
+    TB_CHECKPOINT_SEQ(
+        {0,100}, {8.7e3,101}
+    );
+
+    TB_BEGIN
+    TB_CHECKPOINT(100);
+    TB_SCRIPT(script);
+    TB_CHECKPOINT(101);
+    TB_END
+}
+
+void script_deadline_tick(bs_time_t HW_device_time)
+{
+    TB_BEGIN
+    // Aborted in the first WAIT of the script
+    TB_CALL_W_DEADLINE_DELTA(500, tb_script_run, script);
+    TB_ASSERT(TB_CALL_TIMED_OUT, "Script did not time out");
+    TB_END
+}
+
+static void run(tb_defs_unit_test_tick_handler_t tick_handler)
+{
+    tb_defs_unit_test_reset();
+    TB_RESET(tb_context_ptr);
+    nbr_entries = 0;
+    nbr_rx = 0;
+    nbr_rx_handled = 0;
+    current_tick = tick_handler;
+    bst_ticker_set_next_tick_absolute(0);
+    tb_defs_unit_test_scheduler(tick_handler);
+}
+
+static void check_compile_error(const char *text, const char *expected_err)
+{
+    tb_script_program_t program;
+    char err[256];
+    TB_ASSERT(!tb_script_compile(text, "inline", &program, err, sizeof(err)), "Script compiled: %s", text);
+    TB_ASSERT(strcmp(err, expected_err) == 0, "Error \"%s\" instead of \"%s\"", err, expected_err);
+}
+
+int main()
+{
+    const tb_checkpoint_t *macro_checkpoints;
+    unsigned int macro_nbr_entries;
+    tb_script_program_t program;
+    char err[256];
+    int idx;
+
+    TB_TEST_STEP("Macro sequence");
+    run(macro_tick);
+    TB_ASSERT(tb_context_ptr->checkpoint_idx == tb_context_ptr->nbr_checkpoints, "Macro sequence not completed");
+    macro_checkpoints = tb_context_ptr->checkpoints;
+    macro_nbr_entries = nbr_entries;
+
+    TB_TEST_STEP("Script aborted by TB_CALL_W_DEADLINE");
+    script = TB_SCRIPT_LOAD(SCRIPT_PATH, bindings);
+    run(script_deadline_tick);
+    TB_ASSERT(tm_get_hw_time() == 500 && script->checkpoint_idx == 1, "Aborted at %u after %d checkpoints",
+        (unsigned int)tm_get_hw_time(), script->checkpoint_idx);
+
+    // Started over, as the script was aborted
+    TB_TEST_STEP("Script");
+    run(script_tick);
+    TB_ASSERT(script->checkpoint_idx == script->program.nbr_checkpoints, "Script not completed");
+    TB_ASSERT(nbr_entries == macro_nbr_entries, "%u entries instead of %u", nbr_entries, macro_nbr_entries);
+    for (idx = 0; idx < script->checkpoint_idx; idx++)
+        TB_ASSERT(script->checkpoints[idx].time == macro_checkpoints[idx].time &&
+            script->checkpoints[idx].val == macro_checkpoints[idx].val, "Checkpoint %d differs", idx);
+
+    TB_TEST_STEP("Script called by a sequence with checkpoints");
+    run(script_w_seq_tick);
+    TB_ASSERT(script->checkpoint_idx == script->program.nbr_checkpoints, "Script not completed");
+    TB_ASSERT(tb_context_ptr->checkpoint_idx == 2 && tm_get_hw_time() == 8.7e3, "Sequence not completed");
+
+    TB_TEST_STEP("Script run by another context");
+    tb_defs_unit_test_expect_fatal_error(TB_PRINT_PREFIX "TB_ASSERT failed: Script run by more than one test bench "
+        "context (load it once per context)!\n");
+    tb_script_run(&other_context, script);
+    tb_defs_unit_test_check_no_pending_fatal_error();
+
+    TB_TEST_STEP("Compiled script");
+    TB_ASSERT(tb_script_read(SCRIPT_PATH, &program, err, sizeof(err)), "%s", err);
+    TB_ASSERT(tb_script_write(&program, COMPILED_SCRIPT_PATH), "Cannot write " COMPILED_SCRIPT_PATH);
+    tb_script_program_free(&program);
+    tb_script_free(script);
+    script = TB_SCRIPT_LOAD(COMPILED_SCRIPT_PATH, bindings);
+    run(script_tick);
+    TB_ASSERT(script->checkpoint_idx == script->program.nbr_checkpoints, "Compiled script not completed");
+    TB_ASSERT(nbr_entries == macro_nbr_entries, "%u entries instead of %u", nbr_entries, macro_nbr_entries);
+    tb_script_free(script);
+
+    TB_TEST_STEP("Script with deferred checkpoints");
+    script = TB_SCRIPT_LOAD(CHECKPOINTS_SCRIPT_PATH, bindings);
+    tb_context_ptr->defer_checkpoints = true;
+    tb_defs_unit_test_reset();
+    TB_RESET(tb_context_ptr);
+    tb_defs_unit_test_expect_fatal_error(TB_PRINT_PREFIX "TB_ASSERT failed: TB_CHECKPOINT != TB_CHECKPOINT_SEQ[1]: "
+        "actual value=3, expected value=2, expected time=00:00:00.000000\n");
+    current_tick = script_tick;
+    bst_ticker_set_next_tick_absolute(0);
+    tb_defs_unit_test_scheduler(script_tick);
+    tb_defs_unit_test_check_no_pending_fatal_error();
+    // Logged, and verified only when the script waited
+    TB_ASSERT(nbr_logged == 2, "%u checkpoints logged", nbr_logged);
+    TB_ASSERT(script->checkpoint_idx == 3, "%d checkpoints verified", script->checkpoint_idx);
+    tb_context_ptr->defer_checkpoints = false;
+    tb_script_free(script);
+
+    TB_TEST_STEP("Script errors");
+    tb_defs_unit_test_expect_fatal_error(TB_PRINT_PREFIX "TB_ASSERT failed: " SCRIPT_PATH
+        ": No predicate bound to the name is_rx_pending\n");
+    script = TB_SCRIPT_LOAD(SCRIPT_PATH, partial_bindings);
+    tb_defs_unit_test_check_no_pending_fatal_error();
+    TB_ASSERT(script == NULL, "Script loaded without bindings");
+    check_compile_error("WAIT 1e3\nENDIF\n", "inline:2: ENDIF with no matching IF");
+    check_compile_error("FOR 2\n  WAIT 1\n", "inline:1: FOR not ended");
+    check_compile_error("CALL missing\n", "inline:1: Undefined procedure missing");
+    check_compile_error("WAIT 1.5\n", "inline:1: '1.5' is not a whole, non-negative number of microseconds");
+    check_compile_error("\n# Comment\nJUMP 3\n", "inline:3: Unknown statement 'JUMP'");
+    check_compile_error("BREAK\n", "inline:1: BREAK not inside loop");
+    check_compile_error("CHECKPOINT_SEQ {2,1} {1,2}\n", "inline:1: CHECKPOINT_SEQ times must be in non-decreasing order");
+    check_compile_error("WAIT 1 2\n", "inline:1: Unexpected text after the statement");
+    // A compiled script with an out of range number of loop counters (the header word after the magic "TBSCRIPT" and
+    // the version and the numbers of instructions, names, and checkpoints)
+    {
+        FILE *file = fopen(COMPILED_SCRIPT_PATH, "r+b");
+        uint32_t nbr_loop_counters = UINT32_MAX;
+        TB_ASSERT(file && fseek(file, 8 + 4 * sizeof(uint32_t), SEEK_SET) == 0 &&
+            fwrite(&nbr_loop_counters, sizeof(nbr_loop_counters), 1, file) == 1, "Cannot patch " COMPILED_SCRIPT_PATH);
+        fclose(file);
+    }
+    TB_ASSERT(!tb_script_read(COMPILED_SCRIPT_PATH, &program, err, sizeof(err)), "Invalid compiled script read");
+    TB_ASSERT(strcmp(err, COMPILED_SCRIPT_PATH ": Invalid or incompatible compiled script") == 0, "Error \"%s\"", err);
+
+    TB_TEST_STEP("Test ended - all OK!");
+    return 0;
+}
@@ -0,0 +1,147 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// The purpose of this test bench is to test the shared variable table (tb_shared.h): two test bench contexts with their
+// own mappings of the same table coordinating through it (device A in this file, device B in
+// tb_defs_unit_test_shared_dev_b.c), no torn reads while another process writes, the anonymous table shared with a
+// child process, and an incompatible table being rejected.
+
+// For fork() and friends
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs.h"
+#include "tb_defs_unit_test_shared.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Device A: "
+
+#define INCOMPATIBLE_PATH "tb_defs_unit_test_shared_incompatible.shm"
+#define NBR_STRESS_WRITES 2000000
+
+TB_GLOBALS
+
+static tb_ticker_t dev_a_ticker;
+static tb_shared_t *shared;
+static tb_shared_var_t *phase;
+static tb_shared_var_t *params;
+static tb_shared_var_t *ack;
+
+void dev_a_tick(bs_time_t HW_device_time)
+{
+    TB_CHECKPOINT_SEQ(
+        {1e3,1}, {1.7e3,2}, {1.7e3,-1}
+    );
+    TB_TICKER(&dev_a_ticker);
+
+    TB_BEGIN
+    TB_WAIT(1e3);
+    TB_SHARED_SET(phase, 1);
+    TB_CHECKPOINT(1);
+    // Re-checked after 100, 300, and 700 us; device B acknowledges at 1500 us
+    TB_WAIT_COND_POLL(TB_SHARED_GET(ack) == 1, 100, 1e3, TIME_NEVER);
+    TB_CHECKPOINT(2);
+    {
+        conn_params_t conn_params;
+        bs_time_t write_time = TB_SHARED_READ(params, &conn_params, sizeof(conn_params));
+        TB_ASSERT(write_time == 1.5e3 && conn_params.conn_interval == 7500 && conn_params.latency == 4 &&
+            conn_params.access_address == 0x8e89bed6aabbccddULL, "Wrong connection parameters");
+    }
+    TB_END
+}
+
+// Writes values of which all words are equal, through its own mapping of the table
+static void stress_writer(void)
+{
+    tb_shared_t *writer_shared = TB_SHARED_OPEN(SHARED_PATH);
+    tb_shared_var_t *var = TB_SHARED_VAR(writer_shared, "stress");
+    uint64_t words[3];
+    unsigned int i;
+    for (i = 1; i <= NBR_STRESS_WRITES; i++)
+    {
+        words[0] = words[1] = words[2] = i;
+        TB_SHARED_WRITE(var, words, sizeof(words));
+    }
+    _exit(0);
+}
+
+int main()
+{
+    tb_shared_var_t *var;
+    uint64_t words[3];
+    uint64_t last_val = 0;
+    pid_t pid;
+    int status;
+    FILE *file;
+
+    TB_TEST_STEP("Two devices");
+    // A table left over by a previous run would hold its values
+    unlink(SHARED_PATH);
+    shared = TB_SHARED_OPEN(SHARED_PATH);
+    phase = TB_SHARED_VAR(shared, "phase");
+    params = TB_SHARED_VAR(shared, "params");
+    ack = TB_SHARED_VAR(shared, "ack");
+    dev_b_init();
+    dev_a_ticker.set_next_tick_absolute = tb_defs_unit_test_device_set_next_tick_absolute;
+    dev_a_ticker.arg = tb_defs_unit_test_add_device(dev_a_tick);
+    dev_b_ticker.set_next_tick_absolute = tb_defs_unit_test_device_set_next_tick_absolute;
+    dev_b_ticker.arg = tb_defs_unit_test_add_device(dev_b_tick);
+    tb_defs_unit_test_device_set_next_tick_absolute(dev_a_ticker.arg, 0);
+    tb_defs_unit_test_device_set_next_tick_absolute(dev_b_ticker.arg, 0);
+    tb_defs_unit_test_scheduler(NULL);
+    TB_CHECKPOINT(-1);
+    dev_b_check_done();
+
+    TB_TEST_STEP("Reads while another process writes");
+    var = TB_SHARED_VAR(shared, "stress");
+    fflush(stdout);
+    pid = fork();
+    TB_ASSERT(pid >= 0, "fork failed");
+    if (pid == 0)
+        stress_writer();
+    while (last_val < NBR_STRESS_WRITES)
+    {
+        TB_SHARED_READ(var, words, sizeof(words));
+        TB_ASSERT(words[0] == words[1] && words[1] == words[2], "Torn read: %u %u %u", (unsigned int)words[0],
+            (unsigned int)words[1], (unsigned int)words[2]);
+        TB_ASSERT(words[0] >= last_val, "Value went back from %u to %u", (unsigned int)last_val,
+            (unsigned int)words[0]);
+        last_val = words[0];
+    }
+    TB_ASSERT(waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0, "Writer failed");
+    tb_shared_close(shared);
+    unlink(SHARED_PATH);
+
+    TB_TEST_STEP("Anonymous table");
+    shared = TB_SHARED_OPEN(NULL);
+    var = TB_SHARED_VAR(shared, "child");
+    fflush(stdout);
+    pid = fork();
+    TB_ASSERT(pid >= 0, "fork failed");
+    if (pid == 0)
+    {
+        TB_SHARED_SET(TB_SHARED_VAR(shared, "child"), 42);
+        _exit(0);
+    }
+    TB_ASSERT(waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0, "Child failed");
+    TB_ASSERT(TB_SHARED_GET(var) == 42, "Value %d instead of 42", (int)TB_SHARED_GET(var));
+    tb_shared_close(shared);
+
+    TB_TEST_STEP("Incompatible table");
+    file = fopen(INCOMPATIBLE_PATH, "w");
+    TB_ASSERT(file != NULL && fputs("Not a table", file) >= 0 && fclose(file) == 0, "Cannot write file");
+    tb_defs_unit_test_expect_fatal_error(TB_PRINT_PREFIX "TB_ASSERT failed: " INCOMPATIBLE_PATH
+        " is not a compatible shared variable table\n");
+    shared = TB_SHARED_OPEN(INCOMPATIBLE_PATH);
+    tb_defs_unit_test_check_no_pending_fatal_error();
+    TB_ASSERT(shared == NULL, "Incompatible table opened");
+    unlink(INCOMPATIBLE_PATH);
+
+    TB_TEST_STEP("Test ended - all OK!");
+    return 0;
+}
@@ -0,0 +1,27 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef TB_DEFS_UNIT_TEST_SHARED_H
+#define TB_DEFS_UNIT_TEST_SHARED_H
+
+// This file contains the definitions shared by the two test bench contexts of tb_defs_unit_test_shared.c.
+
+#include "tb_shared.h"
+
+#define SHARED_PATH "tb_defs_unit_test_shared.shm"
+
+typedef struct
+{
+    uint32_t conn_interval;
+    uint32_t latency;
+    uint64_t access_address;
+} conn_params_t;
+
+extern tb_ticker_t dev_b_ticker;
+void dev_b_init(void);
+void dev_b_tick(bs_time_t HW_device_time);
+void dev_b_check_done(void);
+
+#endif // #ifndef TB_DEFS_UNIT_TEST_SHARED_H
@@ -0,0 +1,61 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// This file contains the test bench context of device B used by tb_defs_unit_test_shared.c. It has its own mapping of
+// the shared variable table, like a device running in its own process.
+
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs.h"
+#include "tb_defs_unit_test_shared.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Device B: "
+
+TB_GLOBALS
+
+tb_ticker_t dev_b_ticker;
+static tb_shared_t *shared;
+static tb_shared_var_t *phase;
+static tb_shared_var_t *params;
+static tb_shared_var_t *ack;
+static int64_t phase_val;
+static bs_time_t phase_time;
+
+void dev_b_init(void)
+{
+    shared = TB_SHARED_OPEN(SHARED_PATH);
+    // Looked up in a different order than by device A
+    ack = TB_SHARED_VAR(shared, "ack");
+    params = TB_SHARED_VAR(shared, "params");
+    phase = TB_SHARED_VAR(shared, "phase");
+}
+
+void dev_b_tick(bs_time_t HW_device_time)
+{
+    TB_CHECKPOINT_SEQ(
+        {1.5e3,10}, {1.7e3,-1}
+    );
+    TB_TICKER(&dev_b_ticker);
+
+    TB_BEGIN
+    // Re-checked after 100, 300, 700, and 1500 us; device A sets the phase at 1000 us
+    TB_WAIT_COND_POLL(TB_SHARED_GET(phase) == 1, 100, 1e3, TIME_NEVER);
+    phase_time = TB_SHARED_READ(phase, &phase_val, sizeof(phase_val));
+    TB_ASSERT(phase_val == 1 && phase_time == 1e3, "Phase %d written at %u", (int)phase_val,
+        (unsigned int)phase_time);
+    {
+        conn_params_t conn_params = { .conn_interval = 7500, .latency = 4, .access_address = 0x8e89bed6aabbccddULL };
+        TB_SHARED_WRITE(params, &conn_params, sizeof(conn_params));
+    }
+    TB_SHARED_SET(ack, 1);
+    TB_CHECKPOINT(10);
+    TB_END
+}
+
+void dev_b_check_done(void)
+{
+    TB_CHECKPOINT(-1);
+    tb_shared_close(shared);
+}
@@ -0,0 +1,88 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// The purpose of this test bench is to test the run summary (TB_RUN_SUMMARY): the counters of tick handler entries,
+// signalled events, loop ticks and ticker programmings must match the test sequence, only the top level sequence must
+// be counted, and TB_RESET must restart the counting.
+
+#define TB_RUN_SUMMARY true
+
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Summary test: "
+
+TB_GLOBALS
+
+void test_tick(bs_time_t HW_device_time);
+
+static bool is_rx_done;
+static int loop_idx;
+static unsigned int nbr_summary_entries;  // At TB_END, i.e. when the summary was printed
+
+static void rx_handler(void)
+{
+    is_rx_done = true;
+    TB_SIGNAL_EVENT(test_tick);
+}
+
+void wait_sub(TB_CONTEXT_PARAM)
+{
+    TB_BEGIN
+    TB_WAIT(100);
+    TB_END
+}
+
+void test_tick(bs_time_t HW_device_time)
+{
+    TB_BEGIN
+    TB_WAIT(1e3);
+    TB_FOR(loop_idx = 0, loop_idx < 3, loop_idx++)
+    TB_ENDFOR
+    tb_defs_unit_test_schedule_special_event_delta(500, rx_handler);
+    TB_WAIT_COND(is_rx_done);
+    TB_CALL(wait_sub);
+    nbr_summary_entries = tb_context_ptr->nbr_entries;
+    TB_END
+}
+
+static void run(void)
+{
+    tb_defs_unit_test_reset();
+    TB_RESET(tb_context_ptr);
+    is_rx_done = false;
+    bst_ticker_set_next_tick_absolute(0);
+    tb_defs_unit_test_scheduler(test_tick);
+}
+
+static void check_counters(void)
+{
+    // Start, 1e3, the 3 loop iterations, the rx, and the end of the wait of the sub-test sequence
+    TB_ASSERT(tb_context_ptr->nbr_entries == 7 && nbr_summary_entries == 7, "%u entries",
+        tb_context_ptr->nbr_entries);
+    TB_ASSERT(tb_context_ptr->nbr_signal_entries == 1 && tb_context_ptr->nbr_signals == 1, "%u signal entries",
+        tb_context_ptr->nbr_signal_entries);
+    TB_ASSERT(tb_context_ptr->nbr_loop_ticks == 3, "%u loop ticks", tb_context_ptr->nbr_loop_ticks);
+    // The two waits and the 3 loop iterations
+    TB_ASSERT(tb_context_ptr->nbr_ticker_programs == 5, "%u ticker programmings",
+        tb_context_ptr->nbr_ticker_programs);
+    TB_ASSERT(tb_context_ptr->start_time == 0, "Started at %u", (unsigned int)tb_context_ptr->start_time);
+    TB_ASSERT(tm_get_hw_time() == 1.6e3, "Ended at %u", (unsigned int)tm_get_hw_time());
+}
+
+int main()
+{
+    TB_TEST_STEP("Counters of the run");
+    run();
+    check_counters();
+
+    TB_TEST_STEP("Counters restarted by TB_RESET");
+    run();
+    check_counters();
+
+    TB_TEST_STEP("Test ended - all OK!");
+    return 0;
+}
@@ -0,0 +1,88 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// The purpose of this test bench is to test the synchronization objects (TB_SEM/TB_EVENT/TB_BARRIER) shared between
+// two test bench contexts running in the same process: device A (in this file) and device B (in
+// tb_defs_unit_test_sync_dev_b.c).
+
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs.h"
+#include "tb_defs_unit_test_sync.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Device A: "
+
+TB_GLOBALS
+
+tb_sem_t adv_sem = TB_SEM_INIT(0);
+tb_event_t conn_event = TB_EVENT_INIT;
+tb_barrier_t barrier = TB_BARRIER_INIT(2);
+
+static tb_ticker_t dev_a_ticker;
+static int i;
+
+void dev_a_tick(bs_time_t HW_device_time)
+{
+    TB_CHECKPOINT_SEQ(
+        // SEM test
+        {1e6,1}, {2e6,1}, {3e6,1},
+
+        // EVENT test
+        {5e6,2},
+
+        // BARRIER test
+        {8e6,3}, {9e6,4},
+
+        // END
+        {9e6,-1},
+    );
+    TB_TICK_HANDLER(dev_a_tick);
+    TB_TICKER(&dev_a_ticker);
+
+    TB_BEGIN
+
+    TB_TEST_STEP("SEM test");
+    // Advertise 3 times; device B waits for the advertisements
+    TB_FOR(i = 0, i < 3, i++)
+        TB_WAIT(1e6);
+        TB_CHECKPOINT(1);
+        TB_SEM_GIVE(adv_sem);
+    TB_ENDFOR
+
+    TB_TEST_STEP("EVENT test");
+    // Wait for device B to set the event
+    TB_EVENT_WAIT(conn_event);
+    TB_CHECKPOINT(2);
+
+    TB_TEST_STEP("BARRIER test");
+    // Device A arrives first
+    TB_WAIT_UNTIL(7e6);
+    TB_BARRIER_WAIT(barrier);
+    TB_CHECKPOINT(3);
+    // Device A arrives last
+    TB_WAIT_UNTIL(9e6);
+    TB_BARRIER_WAIT(barrier);
+    TB_CHECKPOINT(4);
+
+    // Only the EVENT and the first BARRIER must have woken up device A
+    TB_ASSERT(tb_context_ptr->nbr_signal_entries == 2, "%u signal entries", tb_context_ptr->nbr_signal_entries);
+
+    TB_END
+}
+
+int main()
+{
+    dev_a_ticker.set_next_tick_absolute = tb_defs_unit_test_device_set_next_tick_absolute;
+    dev_a_ticker.arg = tb_defs_unit_test_add_device(dev_a_tick);
+    dev_b_ticker.set_next_tick_absolute = tb_defs_unit_test_device_set_next_tick_absolute;
+    dev_b_ticker.arg = tb_defs_unit_test_add_device(dev_b_tick);
+    tb_defs_unit_test_device_set_next_tick_absolute(dev_a_ticker.arg, 0);
+    tb_defs_unit_test_device_set_next_tick_absolute(dev_b_ticker.arg, 0);
+    tb_defs_unit_test_scheduler(NULL);
+    TB_CHECKPOINT(-1);
+    dev_b_check_done();
+    TB_TEST_STEP("Test ended - all OK!");
+    return 0;
+}
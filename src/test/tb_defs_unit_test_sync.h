@@ -0,0 +1,21 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef TB_DEFS_UNIT_TEST_SYNC_H
+#define TB_DEFS_UNIT_TEST_SYNC_H
+
+// This file contains the definitions shared by the two test bench contexts of tb_defs_unit_test_sync.c.
+
+#include "tb_defs.h"
+
+extern tb_sem_t adv_sem;
+extern tb_event_t conn_event;
+extern tb_barrier_t barrier;
+
+extern tb_ticker_t dev_b_ticker;
+void dev_b_tick(bs_time_t HW_device_time);
+void dev_b_check_done(void);
+
+#endif // #ifndef TB_DEFS_UNIT_TEST_SYNC_H
@@ -0,0 +1,69 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// This file contains the test bench context of device B used by tb_defs_unit_test_sync.c.
+
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs.h"
+#include "tb_defs_unit_test_sync.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Device B: "
+
+TB_GLOBALS
+
+tb_ticker_t dev_b_ticker;
+static int i;
+
+void dev_b_tick(bs_time_t HW_device_time)
+{
+    TB_CHECKPOINT_SEQ(
+        // SEM test
+        {2.5e6,10}, {2.5e6,11}, {3e6,12},
+
+        // EVENT test
+        {5e6,20},
+
+        // BARRIER test
+        {8e6,30}, {9e6,31},
+
+        // END
+        {9e6,-1},
+    );
+    TB_TICK_HANDLER(dev_b_tick);
+    TB_TICKER(&dev_b_ticker);
+
+    TB_BEGIN
+
+    // Wait until device A has advertised 3 times; the first two advertisements are already given when starting
+    TB_WAIT(2.5e6);
+    TB_FOR(i = 0, i < 3, i++)
+        TB_SEM_TAKE(adv_sem);
+        TB_CHECKPOINT(10 + i);
+    TB_ENDFOR
+
+    TB_WAIT_UNTIL(5e6);
+    TB_EVENT_SET(conn_event);
+    TB_CHECKPOINT(20);
+
+    // Device B arrives last
+    TB_WAIT_UNTIL(8e6);
+    TB_BARRIER_WAIT(barrier);
+    TB_CHECKPOINT(30);
+    // Device B arrives first
+    TB_WAIT_UNTIL(8.5e6);
+    TB_BARRIER_WAIT(barrier);
+    TB_CHECKPOINT(31);
+
+    // Only the third SEM_GIVE and the second BARRIER must have woken up device B
+    TB_ASSERT(tb_context_ptr->nbr_signal_entries == 2, "%u signal entries", tb_context_ptr->nbr_signal_entries);
+
+    TB_END
+}
+
+void dev_b_check_done(void)
+{
+    TB_CHECKPOINT(-1);
+}
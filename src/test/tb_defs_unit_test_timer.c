@@ -0,0 +1,170 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// The purpose of this test bench is to test the timers (TB_TIMER_START/STOP/EXPIRED, TB_WAIT_TIMER). First a few
+// concurrent timers are combined with waits and conditions, then many timers are randomly started and stopped with
+// delays spanning all levels of the timer wheel, checking that the sequence is woken up exactly at each expiry. Finally,
+// TB_RESET must stop all the timers, expired or not.
+
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Timer test: "
+
+TB_GLOBALS
+
+#define NBR_TIMERS 64
+#define NBR_ROUNDS 500
+
+void test_tick(bs_time_t HW_device_time);
+
+static tb_timer_t retx_timer = TB_TIMER_INIT;
+static tb_timer_t supervision_timer = TB_TIMER_INIT;
+static tb_timer_t deadline_timer = TB_TIMER_INIT;
+static tb_timer_t timers[NBR_TIMERS];
+static bs_time_t expected_expiries[NBR_TIMERS];
+static bool event1;
+static int round_idx;
+
+void event1_handler(void)
+{
+    event1 = true;
+    TB_SIGNAL_EVENT(test_tick);
+}
+
+void retx_start_handler(void)
+{
+    TB_TIMER_START(retx_timer, 1e3);
+}
+
+static bool is_any_timer_running(void)
+{
+    for (int i = 0; i < NBR_TIMERS; i++)
+        if (expected_expiries[i] != TIME_NEVER)
+            return true;
+    return false;
+}
+
+static bool is_any_timer_expired(void)
+{
+    for (int i = 0; i < NBR_TIMERS; i++)
+        if (expected_expiries[i] != TIME_NEVER && TB_TIMER_EXPIRED(timers[i]))
+            return true;
+    return false;
+}
+
+// Starts, restarts, or stops a random timer, with delays from 1 us up to beyond the range of the top wheel level
+static void random_timer_op(void)
+{
+    int i = TB_RAND(0, NBR_TIMERS - 1);
+    if (TB_RAND(0, 3) == 0)
+    {
+        TB_TIMER_STOP(timers[i]);
+        expected_expiries[i] = TIME_NEVER;
+    }
+    else
+    {
+        bs_time_t delay = TB_RAND(1, 1ULL << TB_RAND(0, 40));
+        TB_TIMER_START(timers[i], delay);
+        expected_expiries[i] = tm_get_hw_time() + delay;
+    }
+}
+
+static void check_expired_timers(void)
+{
+    bs_time_t next_expiry = TIME_NEVER;
+    for (int i = 0; i < NBR_TIMERS; i++)
+        if (expected_expiries[i] < next_expiry)
+            next_expiry = expected_expiries[i];
+    TB_ASSERT(next_expiry == tm_get_hw_time(), "Woken up at %llu instead of at first expiry %llu",
+        (unsigned long long)tm_get_hw_time(), (unsigned long long)next_expiry);
+    for (int i = 0; i < NBR_TIMERS; i++)
+    {
+        if (expected_expiries[i] == TIME_NEVER)
+            continue;
+        TB_ASSERT(TB_TIMER_EXPIRED(timers[i]) == (expected_expiries[i] <= tm_get_hw_time()), "Timer %d state", i);
+        if (expected_expiries[i] <= tm_get_hw_time())
+            expected_expiries[i] = TIME_NEVER;
+    }
+}
+
+void test_tick(bs_time_t HW_device_time)
+{
+    TB_CHECKPOINT_SEQ(
+        {7e3,1}, {12e3,2}, {15e3,3}, {100e3,4}, {102e3,5}, {104e3,6}, {10e6,7}
+    );
+
+    TB_BEGIN
+
+    TB_TEST_STEP("Concurrent timers");
+    TB_TIMER_START(retx_timer, 5e3);
+    TB_TIMER_START(supervision_timer, 100e3);
+    TB_TIMER_START(deadline_timer, 10e6);
+    // A timer expiring during a TB_WAIT must not end the wait early
+    TB_WAIT(7e3);
+    TB_CHECKPOINT(1);
+    TB_ASSERT(TB_TIMER_EXPIRED(retx_timer) && !TB_TIMER_EXPIRED(supervision_timer), "Wrong timer states");
+    TB_TIMER_START(retx_timer, 5e3);
+    TB_WAIT_TIMER(retx_timer);
+    TB_CHECKPOINT(2);
+    // A condition combined with a timer, where the condition occurs first
+    tb_defs_unit_test_schedule_special_event_delta(3e3, event1_handler);
+    event1 = false;
+    TB_WAIT_COND(event1 || TB_TIMER_EXPIRED(supervision_timer));
+    TB_CHECKPOINT(3);
+    // ... and where the timer expires first
+    event1 = false;
+    TB_WAIT_COND(event1 || TB_TIMER_EXPIRED(supervision_timer));
+    TB_CHECKPOINT(4);
+    // A stopped timer never expires
+    TB_TIMER_START(retx_timer, 1e3);
+    TB_TIMER_STOP(retx_timer);
+    TB_WAIT_COND_W_DEADLINE_DELTA(TB_TIMER_EXPIRED(retx_timer), 2e3);
+    TB_CHECKPOINT(5);
+    // A timer started by an event handler while waiting
+    tb_defs_unit_test_schedule_special_event_delta(1e3, retx_start_handler);
+    TB_WAIT_COND_W_DEADLINE_DELTA(TB_TIMER_EXPIRED(retx_timer), 1e6);
+    TB_CHECKPOINT(6);
+    TB_WAIT_TIMER(deadline_timer);
+    TB_CHECKPOINT(7);
+
+    TB_TEST_STEP("Random timers");
+    TB_FOR(round_idx = 0, round_idx < NBR_ROUNDS, round_idx++)
+        // Now and then, stop all timers, so that long timers also get to expire, cascading through all wheel levels
+        if (round_idx % 16 == 0)
+        {
+            for (int i = 0; i < NBR_TIMERS; i++)
+            {
+                TB_TIMER_STOP(timers[i]);
+                expected_expiries[i] = TIME_NEVER;
+            }
+        }
+        for (int i = 0; i < 4 || !is_any_timer_running(); i++)
+            random_timer_op();
+        TB_WAIT_COND(is_any_timer_expired());
+        check_expired_timers();
+    TB_ENDFOR
+
+    TB_END
+}
+
+int main()
+{
+    bst_ticker_set_next_tick_absolute(0);
+    tb_defs_unit_test_scheduler(test_tick);
+    TB_ASSERT(round_idx == NBR_ROUNDS, "Test ended after %d of %d rounds", round_idx, NBR_ROUNDS);
+
+    TB_TEST_STEP("Timers stopped by TB_RESET");
+    // Both the expired timers and those still running
+    TB_ASSERT(TB_TIMER_EXPIRED(deadline_timer) && is_any_timer_running(), "No expired or running timers to reset");
+    TB_RESET(tb_context_ptr);
+    TB_ASSERT(!TB_TIMER_EXPIRED(retx_timer) && !TB_TIMER_EXPIRED(supervision_timer) &&
+        !TB_TIMER_EXPIRED(deadline_timer), "Expired timer not stopped by TB_RESET");
+    for (int i = 0; i < NBR_TIMERS; i++)
+        TB_ASSERT(!timers[i].is_in_wheel && timers[i].expiry == TIME_NEVER, "Timer %d not stopped by TB_RESET", i);
+    TB_TEST_STEP("Test ended - all OK!");
+    return 0;
+}
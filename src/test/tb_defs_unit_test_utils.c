@@ -10,7 +10,6 @@
 // This file contains utilities needed for testing tb_defs.h.
 
 #include <string.h>
-#include <stdarg.h>
 #include "tb_defs_unit_test_utils.h"
 
 //////////////////////////////////////////////////////////////////////////////////////////////////
@@ -55,28 +54,112 @@ void bst_ticker_set_next_tick_delta(bs_time_t d)
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // Unit testing stuff
 
-static bs_time_t tb_defs_unit_test_special_event_time = TIME_NEVER;
-static tb_defs_unit_test_event_handler_t tb_defs_unit_test_event_handler = NULL;
+#define TB_DEFS_UNIT_TEST_MAX_SPECIAL_EVENTS 16
+
+// Pending special events, sorted by time (events scheduled for the same time are handled in the order scheduled). All
+// special events at a time are handled before the ticks at that time, so that the tick entries caused by several
+// TB_SIGNAL_EVENTs at the same time can be coalesced (TB_DEFER_SIGNALS), and a tick sees the events of its own time.
+static struct
+{
+    bs_time_t time;
+    tb_defs_unit_test_event_handler_t event_handler;
+} tb_defs_unit_test_special_events[TB_DEFS_UNIT_TEST_MAX_SPECIAL_EVENTS];
+static int tb_defs_unit_test_nbr_special_events = 0;
+
+#define TB_DEFS_UNIT_TEST_MAX_DEVICES 8
+
+// Additional devices, each with its own tick handler and ticker, running in the same process
+typedef struct
+{
+    tb_defs_unit_test_tick_handler_t tick_handler;
+    bs_time_t next_tick_time;
+} tb_defs_unit_test_device_t;
+
+static tb_defs_unit_test_device_t tb_defs_unit_test_devices[TB_DEFS_UNIT_TEST_MAX_DEVICES];
+static int tb_defs_unit_test_nbr_devices = 0;
 static char *tb_defs_unit_test_expected_fatal_error = NULL;
+static bool tb_defs_unit_test_is_stopped = false;
 
 void tb_defs_unit_test_schedule_special_event_delta(bs_time_t d, tb_defs_unit_test_event_handler_t event_handler)
 {
-    tb_defs_unit_test_special_event_time = now + d;
-    tb_defs_unit_test_event_handler = event_handler;
+    int i;
+    if (tb_defs_unit_test_nbr_special_events == TB_DEFS_UNIT_TEST_MAX_SPECIAL_EVENTS)
+        tb_defs_unit_test_fatal_error(__LINE__, now, "Too many special events scheduled!\n");
+    for (i = tb_defs_unit_test_nbr_special_events;
+         i > 0 && tb_defs_unit_test_special_events[i - 1].time > now + d; i--)
+        tb_defs_unit_test_special_events[i] = tb_defs_unit_test_special_events[i - 1];
+    tb_defs_unit_test_special_events[i].time = now + d;
+    tb_defs_unit_test_special_events[i].event_handler = event_handler;
+    tb_defs_unit_test_nbr_special_events++;
+}
+
+void *tb_defs_unit_test_add_device(tb_defs_unit_test_tick_handler_t tick_handler)
+{
+    tb_defs_unit_test_device_t *device = &tb_defs_unit_test_devices[tb_defs_unit_test_nbr_devices];
+    if (tb_defs_unit_test_nbr_devices == TB_DEFS_UNIT_TEST_MAX_DEVICES)
+        tb_defs_unit_test_fatal_error(__LINE__, now, "Too many devices added!\n");
+    tb_defs_unit_test_nbr_devices++;
+    device->tick_handler = tick_handler;
+    device->next_tick_time = TIME_NEVER;
+    return device;
+}
+
+void tb_defs_unit_test_device_set_next_tick_absolute(void *device, bs_time_t t)
+{
+    ((tb_defs_unit_test_device_t *)device)->next_tick_time = t >= now ? t : TIME_NEVER;
+}
+
+void tb_defs_unit_test_reset(void)
+{
+    now = 0;
+    next_tick_time = TIME_NEVER;
+    tb_defs_unit_test_nbr_special_events = 0;
+    for (int i = 0; i < tb_defs_unit_test_nbr_devices; i++)
+        tb_defs_unit_test_devices[i].next_tick_time = TIME_NEVER;
+    tb_defs_unit_test_expected_fatal_error = NULL;
+    tb_defs_unit_test_is_stopped = false;
+}
+
+void tb_defs_unit_test_stop(void)
+{
+    tb_defs_unit_test_is_stopped = true;
 }
 
 void tb_defs_unit_test_scheduler(tb_defs_unit_test_tick_handler_t tick_handler)
 {
-    // Repeatedly handle next event until no new event has been scheduled
-    while (next_tick_time != TIME_NEVER || tb_defs_unit_test_special_event_time != TIME_NEVER)
+    // Repeatedly handle next event until no new event has been scheduled, or the simulation is stopped
+    while (!tb_defs_unit_test_is_stopped)
     {
+        // Find the next tick of the added devices, if any comes before the next tick
+        tb_defs_unit_test_device_t *device = NULL;
+        bs_time_t device_tick_time = next_tick_time;
+        for (int i = 0; i < tb_defs_unit_test_nbr_devices; i++)
+        {
+            if (tb_defs_unit_test_devices[i].next_tick_time < device_tick_time)
+            {
+                device = &tb_defs_unit_test_devices[i];
+                device_tick_time = device->next_tick_time;
+            }
+        }
+        if (device_tick_time == TIME_NEVER && tb_defs_unit_test_nbr_special_events == 0)
+            break;
+
         // Handle whichever event comes next
-        if (tb_defs_unit_test_special_event_time < next_tick_time)
+        if (tb_defs_unit_test_nbr_special_events > 0 && tb_defs_unit_test_special_events[0].time <= device_tick_time)
+        {
+            // Special event happens before (or at the same time as) next tick, so handle special event now
+            tb_defs_unit_test_event_handler_t event_handler = tb_defs_unit_test_special_events[0].event_handler;
+            now = tb_defs_unit_test_special_events[0].time;
+            memmove(&tb_defs_unit_test_special_events[0], &tb_defs_unit_test_special_events[1],
+                --tb_defs_unit_test_nbr_special_events * sizeof(tb_defs_unit_test_special_events[0]));
+            event_handler();
+        }
+        else if (device != NULL)
         {
-            // Special event happens before next tick, so handle special event now
-            now = tb_defs_unit_test_special_event_time;
-            tb_defs_unit_test_special_event_time = TIME_NEVER;
-            tb_defs_unit_test_event_handler();
+            // Handle next tick of added device
+            now = device->next_tick_time;
+            device->next_tick_time = TIME_NEVER;
+            device->tick_handler(now);
         }
         else
         {
@@ -90,12 +173,17 @@ void tb_defs_unit_test_scheduler(tb_defs_unit_test_tick_handler_t tick_handler)
 
 void tb_defs_unit_test_fatal_error(unsigned int caller_line, bs_time_t time, const char *format, ...)
 {
-    char strbuf[1024];
-    fprintf(stderr, "%s: ", bs_time_to_str(strbuf, time));
     va_list variable_args;
     va_start(variable_args, format);
-    vsprintf(strbuf, format, variable_args);
+    tb_defs_unit_test_vfatal_error(caller_line, time, format, variable_args);
     va_end(variable_args);
+}
+
+void tb_defs_unit_test_vfatal_error(unsigned int caller_line, bs_time_t time, const char *format, va_list variable_args)
+{
+    char strbuf[1024];
+    fprintf(stderr, "%s: ", bs_time_to_str(strbuf, time));
+    vsprintf(strbuf, format, variable_args);
     if (tb_defs_unit_test_expected_fatal_error)
     {
         if (strcmp(strbuf, tb_defs_unit_test_expected_fatal_error) == 0)
@@ -15,6 +15,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stdarg.h>
+#include <stdbool.h>
 
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // BabbleSim replacements
@@ -27,12 +29,22 @@ typedef uint64_t bs_time_t;
 #define bs_trace_print(_type, _file, _line, _verbosity, _time_type, _time, _fmt, ...) \
     tb_defs_unit_test_fatal_error(_line, _time, _fmt, ##__VA_ARGS__)
 
+#define bs_trace_vprint(_type, _file, _line, _verbosity, _time_type, _time, _fmt, _variable_args) \
+    tb_defs_unit_test_vfatal_error(_line, _time, _fmt, _variable_args)
+
 #define bs_trace_raw_time(_verbosity, _fmt, ...) \
     { \
         char strbuf[20]; \
         printf("%s: " _fmt, bs_time_to_str(strbuf, tm_get_hw_time()), ##__VA_ARGS__); \
     }
 
+#define bs_trace_raw(_verbosity, _fmt, ...) \
+    printf(_fmt, ##__VA_ARGS__)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 char *bs_time_to_str(char *dest, bs_time_t time);
 bs_time_t tm_get_hw_time(void);
 void bst_ticker_set_next_tick_absolute(bs_time_t t);
@@ -45,11 +57,20 @@ typedef void (*tb_defs_unit_test_tick_handler_t)(bs_time_t t);
 typedef void (*tb_defs_unit_test_event_handler_t)(void);
 
 void tb_defs_unit_test_schedule_special_event_delta(bs_time_t d, tb_defs_unit_test_event_handler_t event_handler);
+void *tb_defs_unit_test_add_device(tb_defs_unit_test_tick_handler_t tick_handler);
+void tb_defs_unit_test_device_set_next_tick_absolute(void *device, bs_time_t t);
 void tb_defs_unit_test_scheduler(tb_defs_unit_test_tick_handler_t tick_handler);
+void tb_defs_unit_test_reset(void);
+void tb_defs_unit_test_stop(void);
 void tb_defs_unit_test_fatal_error(unsigned int caller_line, bs_time_t time, const char *format, ...);
+void tb_defs_unit_test_vfatal_error(unsigned int caller_line, bs_time_t time, const char *format, va_list variable_args);
 void tb_defs_unit_test_expect_fatal_error(char *error_msg);
 void _tb_defs_unit_test_check_no_pending_fatal_error(unsigned int caller_line);
 #define tb_defs_unit_test_check_no_pending_fatal_error() \
     _tb_defs_unit_test_check_no_pending_fatal_error(__LINE__)
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif // #ifndef TB_DEFS_UNIT_TEST_UTILS_H
@@ -0,0 +1,90 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// The purpose of this test bench is to test watched variables (TB_WATCH, TB_SET, TB_WAIT_CHANGE, TB_WAIT_COND_WATCH):
+// the event handlers only set the variables, and the test sequence must be entered exactly once per change of the
+// variable it waits for, and not for writes that do not change the value or for changes of other variables.
+
+#include "tb_defs_unit_test_utils.h"
+#include "tb_defs.h"
+
+#undef TB_PRINT_PREFIX
+#define TB_PRINT_PREFIX "Watch test: "
+
+TB_GLOBALS
+
+TB_WATCH(int, link_state);
+TB_WATCH(unsigned int, nbr_rx);
+
+void test_tick(bs_time_t HW_device_time);
+
+static unsigned int nbr_entries;
+static unsigned int nbr_wait_entries;
+
+static void link_down_handler(void) { TB_SET(link_state, 0); }
+static void link_up_handler(void) { TB_SET(link_state, 1); }
+static void rx_handler(void) { TB_SET(nbr_rx, nbr_rx + 1); }
+
+// Sets the variable without TB_SET, and signals the event instead
+static void rx_signal_handler(void)
+{
+    nbr_rx++;
+    TB_SIGNAL_EVENT(test_tick);
+}
+
+void test_tick(bs_time_t HW_device_time)
+{
+    TB_CHECKPOINT_SEQ(
+        {2e3,1}, {5e3,2}, {5e3,3}, {6e3,4}
+    );
+    TB_TICK_HANDLER(test_tick);
+
+    nbr_entries++;
+
+    TB_BEGIN
+    TB_TEST_STEP("Wait for a change");
+    tb_defs_unit_test_schedule_special_event_delta(1e3, link_down_handler);
+    tb_defs_unit_test_schedule_special_event_delta(2e3, link_up_handler);
+    nbr_wait_entries = nbr_entries;
+    // Not woken by the write of the unchanged value at 1e3
+    TB_WAIT_CHANGE(link_state);
+    TB_CHECKPOINT(1);
+    TB_ASSERT(nbr_entries - nbr_wait_entries == 1, "Entered %u times", nbr_entries - nbr_wait_entries);
+
+    TB_TEST_STEP("Wait for a condition on a watched variable");
+    tb_defs_unit_test_schedule_special_event_delta(1e3, rx_handler);
+    tb_defs_unit_test_schedule_special_event_delta(1.5e3, link_down_handler);
+    tb_defs_unit_test_schedule_special_event_delta(2e3, rx_handler);
+    tb_defs_unit_test_schedule_special_event_delta(3e3, rx_handler);
+    nbr_wait_entries = nbr_entries;
+    // Entered at each rx only; not at the link state change, nobody waiting for it
+    TB_WAIT_COND_WATCH(nbr_rx >= 3, nbr_rx);
+    TB_CHECKPOINT(2);
+    TB_ASSERT(nbr_entries - nbr_wait_entries == 3, "Entered %u times", nbr_entries - nbr_wait_entries);
+    TB_ASSERT(nbr_rx_tb_waiters.first == NULL, "Still waiting for nbr_rx");
+
+    TB_TEST_STEP("Condition already true");
+    TB_WAIT_COND_WATCH(nbr_rx >= 3, nbr_rx);
+    TB_CHECKPOINT(3);
+    TB_ASSERT(nbr_rx_tb_waiters.first == NULL, "Waiting for nbr_rx");
+
+    TB_TEST_STEP("Condition true at an entry for other reasons");
+    tb_defs_unit_test_schedule_special_event_delta(1e3, rx_signal_handler);
+    TB_WAIT_COND_WATCH(nbr_rx >= 4, nbr_rx);
+    TB_CHECKPOINT(4);
+    TB_ASSERT(nbr_rx_tb_waiters.first == NULL, "Still waiting for nbr_rx");
+    TB_END
+}
+
+int main()
+{
+    link_state = 0;
+    bst_ticker_set_next_tick_absolute(0);
+    tb_defs_unit_test_scheduler(test_tick);
+    TB_ASSERT(tb_context_ptr->checkpoint_idx == tb_context_ptr->nbr_checkpoints, "Sequence not completed");
+
+    TB_TEST_STEP("Test ended - all OK!");
+    return 0;
+}
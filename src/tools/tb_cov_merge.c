@@ -0,0 +1,283 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// tb_cov_merge merges the coverage files written by test benches built with TB_COVERAGE (see tb_defs.h), and reports
+// the test sequence paths never taken and the runs which add no coverage to the others.
+//
+// Usage: tb_cov_merge [-o <merged file>] <coverage file>...
+//
+// The expansion points of each file are listed in the coverage files themselves, as registered by the test bench, so
+// the sources are not needed. A point is identified by its file, line, and order among the points on that line. A run
+// is reported as redundant if everything it reached is also reached by the remaining (non-redundant) runs.
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_LINE_LEN 65536
+
+typedef struct
+{
+    char *file;
+    unsigned int nbr_points;
+    unsigned int *lines;            // Ascending; repeated for several points on one line
+    bool *is_reached;
+} cov_entry_t;
+
+typedef struct
+{
+    const char *path;
+    cov_entry_t *entries;
+    unsigned int nbr_entries;
+    bool is_redundant;
+} cov_run_t;
+
+static void *xrealloc(void *ptr, size_t size)
+{
+    ptr = realloc(ptr, size);
+    if (ptr == NULL)
+    {
+        fprintf(stderr, "tb_cov_merge: out of memory\n");
+        exit(2);
+    }
+    return ptr;
+}
+
+static char *xstrdup(const char *s)
+{
+    return strcpy(xrealloc(NULL, strlen(s) + 1), s);
+}
+
+// Index of the point which is the ordinal'th one on the line, or -1 if the entry has no such point
+static int find_point(const cov_entry_t *entry, unsigned int line, unsigned int ordinal)
+{
+    for (unsigned int i = 0; i < entry->nbr_points; i++)
+        if (entry->lines[i] == line && ordinal-- == 0)
+            return i;
+    return -1;
+}
+
+// Number of points before point idx on the same line
+static unsigned int point_ordinal(const cov_entry_t *entry, unsigned int idx)
+{
+    unsigned int ordinal = 0;
+    while (ordinal < idx && entry->lines[idx - ordinal - 1] == entry->lines[idx])
+        ordinal++;
+    return ordinal;
+}
+
+static cov_entry_t *find_entry(cov_entry_t *entries, unsigned int nbr_entries, const char *file)
+{
+    for (unsigned int i = 0; i < nbr_entries; i++)
+        if (strcmp(entries[i].file, file) == 0)
+            return &entries[i];
+    return NULL;
+}
+
+// ORs the reached points into the entry for the same file in the list, adding the entry and any points it lacks
+static void merge_entry(cov_entry_t **entries, unsigned int *nbr_entries, const cov_entry_t *src)
+{
+    cov_entry_t *dst = find_entry(*entries, *nbr_entries, src->file);
+    cov_entry_t merged;
+    unsigned int d = 0;
+    unsigned int s = 0;
+    if (dst == NULL)
+    {
+        *entries = xrealloc(*entries, (*nbr_entries + 1) * sizeof(cov_entry_t));
+        dst = &(*entries)[(*nbr_entries)++];
+        dst->file = src->file;
+        dst->nbr_points = 0;
+        dst->lines = NULL;
+        dst->is_reached = NULL;
+    }
+    // Both lists are sorted by line, and the points on one line are matched in order
+    merged.nbr_points = 0;
+    merged.lines = xrealloc(NULL, (dst->nbr_points + src->nbr_points + 1) * sizeof(unsigned int));
+    merged.is_reached = xrealloc(NULL, (dst->nbr_points + src->nbr_points + 1) * sizeof(bool));
+    while (d < dst->nbr_points || s < src->nbr_points)
+    {
+        bool is_from_dst = s == src->nbr_points || (d < dst->nbr_points && dst->lines[d] <= src->lines[s]);
+        bool is_from_src = d == dst->nbr_points || (s < src->nbr_points && src->lines[s] <= dst->lines[d]);
+        merged.lines[merged.nbr_points] = is_from_dst ? dst->lines[d] : src->lines[s];
+        merged.is_reached[merged.nbr_points] = false;
+        if (is_from_dst)
+            merged.is_reached[merged.nbr_points] |= dst->is_reached[d++];
+        if (is_from_src)
+            merged.is_reached[merged.nbr_points] |= src->is_reached[s++];
+        merged.nbr_points++;
+    }
+    free(dst->lines);
+    free(dst->is_reached);
+    dst->nbr_points = merged.nbr_points;
+    dst->lines = merged.lines;
+    dst->is_reached = merged.is_reached;
+}
+
+static bool read_run(cov_run_t *run)
+{
+    static char line[MAX_LINE_LEN];
+    FILE *f = fopen(run->path, "r");
+    if (f == NULL)
+    {
+        fprintf(stderr, "tb_cov_merge: cannot open %s\n", run->path);
+        return false;
+    }
+    if (fgets(line, sizeof(line), f) == NULL || strcmp(line, "tb_coverage 2\n") != 0)
+    {
+        fprintf(stderr, "tb_cov_merge: %s is not a coverage file\n", run->path);
+        fclose(f);
+        return false;
+    }
+    while (fgets(line, sizeof(line), f))
+    {
+        cov_entry_t entry = { NULL, 0, NULL, NULL };
+        char *p = line;
+        bool is_malformed = strchr(line, '\n') == NULL;
+        line[strcspn(line, "\n")] = '\0';
+        while (!is_malformed)
+        {
+            unsigned int point_line = strtoul(p, &p, 10);
+            entry.lines = xrealloc(entry.lines, (entry.nbr_points + 1) * sizeof(unsigned int));
+            entry.is_reached = xrealloc(entry.is_reached, (entry.nbr_points + 1) * sizeof(bool));
+            entry.lines[entry.nbr_points] = point_line;
+            entry.is_reached[entry.nbr_points] = *p == '*';
+            p += *p == '*';
+            is_malformed = (*p != ',' && *p != ' ') ||
+                (entry.nbr_points > 0 && point_line < entry.lines[entry.nbr_points - 1]);
+            entry.nbr_points++;
+            if (is_malformed || *p++ == ' ')
+                break;
+        }
+        if (is_malformed || *p == '\0')
+        {
+            fprintf(stderr, "tb_cov_merge: malformed line in %s: %s\n", run->path, line);
+            fclose(f);
+            return false;
+        }
+        entry.file = xstrdup(p);
+        merge_entry(&run->entries, &run->nbr_entries, &entry);
+        free(entry.lines);
+        free(entry.is_reached);
+    }
+    fclose(f);
+    return true;
+}
+
+static void report_file(const cov_entry_t *entry)
+{
+    unsigned int nbr_reached = 0;
+    for (unsigned int i = 0; i < entry->nbr_points; i++)
+    {
+        unsigned int nbr_on_line = 1;
+        unsigned int nbr_missed = !entry->is_reached[i];
+        nbr_reached += entry->is_reached[i];
+        for (; i + 1 < entry->nbr_points && entry->lines[i + 1] == entry->lines[i]; i++, nbr_on_line++)
+        {
+            nbr_reached += entry->is_reached[i + 1];
+            nbr_missed += !entry->is_reached[i + 1];
+        }
+        if (nbr_missed > 0 && nbr_on_line == 1)
+            printf("%s:%u: never reached\n", entry->file, entry->lines[i]);
+        else if (nbr_missed > 0)
+            printf("%s:%u: %u of the %u points on the line never reached\n", entry->file, entry->lines[i],
+                nbr_missed, nbr_on_line);
+    }
+    printf("%s: %u of %u expansion points reached\n", entry->file, nbr_reached, entry->nbr_points);
+}
+
+// True if every point reached by the run is also reached by one of the other non-redundant runs
+static bool is_run_redundant(const cov_run_t *runs, unsigned int nbr_runs, unsigned int run_idx)
+{
+    const cov_run_t *run = &runs[run_idx];
+    for (unsigned int e = 0; e < run->nbr_entries; e++)
+        for (unsigned int i = 0; i < run->entries[e].nbr_points; i++)
+        {
+            unsigned int ordinal = point_ordinal(&run->entries[e], i);
+            bool is_covered = false;
+            if (!run->entries[e].is_reached[i])
+                continue;
+            for (unsigned int r = 0; r < nbr_runs && !is_covered; r++)
+            {
+                const cov_entry_t *other;
+                int idx;
+                if (r == run_idx || runs[r].is_redundant)
+                    continue;
+                other = find_entry(runs[r].entries, runs[r].nbr_entries, run->entries[e].file);
+                idx = other ? find_point(other, run->entries[e].lines[i], ordinal) : -1;
+                is_covered = idx >= 0 && other->is_reached[idx];
+            }
+            if (!is_covered)
+                return false;
+        }
+    return true;
+}
+
+static bool write_merged(const char *path, const cov_entry_t *entries, unsigned int nbr_entries)
+{
+    FILE *f = fopen(path, "w");
+    if (f == NULL)
+        return false;
+    fprintf(f, "tb_coverage 2\n");
+    for (unsigned int e = 0; e < nbr_entries; e++)
+    {
+        for (unsigned int i = 0; i < entries[e].nbr_points; i++)
+            fprintf(f, "%u%s%s", entries[e].lines[i], entries[e].is_reached[i] ? "*" : "",
+                i + 1 < entries[e].nbr_points ? "," : " ");
+        fprintf(f, "%s\n", entries[e].file);
+    }
+    return fclose(f) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *merged_path = NULL;
+    cov_run_t *runs = xrealloc(NULL, argc * sizeof(cov_run_t));
+    unsigned int nbr_runs = 0;
+    cov_entry_t *merged = NULL;
+    unsigned int nbr_merged = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            merged_path = argv[++i];
+        else
+        {
+            runs[nbr_runs].path = argv[i];
+            runs[nbr_runs].entries = NULL;
+            runs[nbr_runs].nbr_entries = 0;
+            runs[nbr_runs].is_redundant = false;
+            if (!read_run(&runs[nbr_runs]))
+                return 1;
+            nbr_runs++;
+        }
+    }
+    if (nbr_runs == 0)
+    {
+        fprintf(stderr, "Usage: %s [-o <merged file>] <coverage file>...\n", argv[0]);
+        return 1;
+    }
+
+    for (unsigned int r = 0; r < nbr_runs; r++)
+        for (unsigned int e = 0; e < runs[r].nbr_entries; e++)
+            merge_entry(&merged, &nbr_merged, &runs[r].entries[e]);
+    if (merged_path && !write_merged(merged_path, merged, nbr_merged))
+    {
+        fprintf(stderr, "tb_cov_merge: cannot write %s\n", merged_path);
+        return 1;
+    }
+
+    for (unsigned int e = 0; e < nbr_merged; e++)
+        report_file(&merged[e]);
+
+    // Later runs are dropped first, so that of several equivalent runs the first one is kept
+    for (unsigned int r = nbr_runs; r-- > 0;)
+    {
+        runs[r].is_redundant = nbr_runs > 1 && is_run_redundant(runs, nbr_runs, r);
+        if (runs[r].is_redundant)
+            printf("%s: redundant (adds no coverage to the other runs)\n", runs[r].path);
+    }
+    return 0;
+}
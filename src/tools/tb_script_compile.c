@@ -0,0 +1,38 @@
+/**
+ * Copyright 2026 Oticon A/S
+ * SPDX-License-Identifier: MIT
+ */
+
+// tb_script_compile compiles a test sequence script (see tb_script.h) ahead of time, so that syntax errors are found
+// before the simulation is run, and the test bench loads the compiled script without compiling it.
+//
+// Usage: tb_script_compile <script> <compiled script>
+
+#include <stdio.h>
+#include "tb_script_compiler.h"
+
+int main(int argc, char *argv[])
+{
+    tb_script_program_t program;
+    char err[256];
+
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: tb_script_compile <script> <compiled script>\n");
+        return 2;
+    }
+    if (!tb_script_read(argv[1], &program, err, sizeof(err)))
+    {
+        fprintf(stderr, "tb_script_compile: %s\n", err);
+        return 1;
+    }
+    if (!tb_script_write(&program, argv[2]))
+    {
+        fprintf(stderr, "tb_script_compile: cannot write %s\n", argv[2]);
+        tb_script_program_free(&program);
+        return 1;
+    }
+    printf("%s: %u instructions\n", argv[1], program.nbr_instrs);
+    tb_script_program_free(&program);
+    return 0;
+}